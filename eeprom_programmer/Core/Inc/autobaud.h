@@ -0,0 +1,53 @@
+/**
+ * @brief Automatic baud rate detection for the VCP (USART2).
+ *
+ * USART2 on the STM32F303x8 doesn't support the USART auto baud rate detection
+ * feature (ABREN is only available on USART1), so the same measurement is done
+ * with TIM2: VCP_RX (PA15) is temporarily routed to TIM2_CH1, and every edge of
+ * the host's first packet is captured by DMA.
+ *
+ * The measurement matches the first command character rather than requiring a
+ * dedicated sync character. Every ASCII character has bit 7 = 0, so its stop
+ * bit always rises exactly 9 bit times after the falling edge of the start bit.
+ * The captured characters are decoded in software, so a first packet of up to
+ * AUTOBAUD_FIRST_PACKET_MAX characters is NOT lost. Characters past the
+ * capture, or sent while the UART is being set up, are dropped or garbled.
+ *
+ * Detection only runs once, after reset. Later rate changes go through the
+ * baud rate negotiation command.
+ *
+ * @file autobaud.h
+ */
+#pragma once
+
+#include "main.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Maximum number of captured edges. A character has at most 10 edges.
+ */
+#define AUTOBAUD_EDGES_MAX 64U
+/**
+ * @brief Length of the longest first packet that is always captured whole,
+ * whatever its characters.
+ */
+#define AUTOBAUD_FIRST_PACKET_MAX (AUTOBAUD_EDGES_MAX / 10U)
+/**
+ * @brief Measured rates within this tolerance (in percent) of a standard baud
+ * rate are snapped to it.
+ */
+#define AUTOBAUD_STANDARD_TOLERANCE 3U
+
+//* Public Function Prototypes
+/**
+ * @brief Waits for the host to send its first packet, then measures its baud
+ * rate and decodes its characters. Must be called while USART2 is NOT
+ * receiving, since VCP_RX is taken away from USART2 during the measurement.
+ *
+ * @param timeout Time (in ms) to wait for the first character.
+ * @param rx Destination for the decoded characters.
+ * @param rx_len Input: capacity of rx. Output: number of decoded characters.
+ * @return Detected baud rate, or 0 if nothing valid was received in time.
+ */
+uint32_t autobaud_detect(uint32_t timeout, uint8_t* rx, size_t* rx_len);
@@ -0,0 +1,70 @@
+/**
+ * @brief Data and address bus primitives. The 8 data lines are spread over
+ * GPIOA, GPIOB and GPIOF, so every primitive works a port at a time instead of
+ * a pin at a time. Tables, masks and the unrolled shift are generated from the
+ * pin map in bus_pins.h at compile time.
+ *
+ * The address goes out through the two 74HC595s, using the backend selected
+ * by BUS_ADDRESS_BACKEND. With BUS_ADDRESS_GPIO, SER, SRCLK and RCLK share
+ * GPIOA, so each address bit costs two BSRR stores. The 74HC595's setup and
+ * pulse width minimums (timing.h) are held between the stores at compile
+ * time: at 16 MHz a single cycle covers them and no wait is emitted. With
+ * BUS_ADDRESS_SPI, SPI1 clocks the address out as one 16-bit frame while the
+ * CPU moves on, and only RCLK is a GPIO.
+ *
+ * @file bus.h
+ */
+#pragma once
+
+#include "main.h"
+#include <stdint.h>
+
+//* Public Typedefs
+
+typedef enum bus_direction {
+  BUS_INPUT,
+  BUS_OUTPUT,
+} bus_direction_t;
+
+//* Public Function Prototypes
+/**
+ * @brief Sets up the address bus backend. Called once after MX_GPIO_Init().
+ */
+void bus_init(void);
+/**
+ * @brief Turns the data bus around with one MODER update per port. Setting the
+ * current direction again costs a single compare.
+ * @param new_direction `BUS_INPUT` or `BUS_OUTPUT`.
+ */
+void bus_set_direction(bus_direction_t new_direction);
+/**
+ * @brief Reads the data bus. Each port's IDR is sampled once, so all 8 lines
+ * are read at nearly the same instant. The bus must be an input.
+ * @return uint8_t D5 (bit 0) to D12 (bit 7)
+ */
+uint8_t bus_read(void);
+/**
+ * @brief Reads a single data line with one IDR load, e.g. I/O7 for DATA
+ * polling. The bus must be an input.
+ * @param bit 0 (I/O0) to 7 (I/O7).
+ * @return uint8_t Level of the line, 0 for any other bit
+ */
+uint8_t bus_read_bit(uint8_t bit);
+/**
+ * @brief Clocks a 16-bit address into the shift registers, LSB first. The
+ * latched outputs don't change until bus_latch_address(). The SPI backend
+ * returns as soon as the frame is queued.
+ * @param address Word to shift out.
+ */
+void bus_shift_address(uint16_t address);
+/**
+ * @brief Waits for the shift to finish, then pulses RCLK, moving the shifted
+ * address to the address lines.
+ */
+void bus_latch_address(void);
+/**
+ * @brief Drives a byte onto the data bus with a single BSRR store per port, so
+ * all 8 lines settle together. The bus must be an output.
+ * @param byte D5 (bit 0) to D12 (bit 7)
+ */
+void bus_write(uint8_t byte);
@@ -0,0 +1,65 @@
+/**
+ * @brief Board pin map. The single list of how the programmer's bus is wired,
+ * by CubeMX pin label (the `<label>_Pin` and `<label>_GPIO_Port` defines of
+ * main.h). The bus accessors in bus.c are generated from it at compile time:
+ * data read and write tables, direction masks and the address shift. A board
+ * wired differently only changes the labels in the .ioc and this file.
+ *
+ * @file bus_pins.h
+ */
+#pragma once
+
+#include "main.h"
+
+//* Pin Map
+/**
+ * ? Pins to SN74HC595 Shift Registers
+ * SER (Serial), SRCLK (Shift Register Clock), RCLK (Storage Register Clock)
+ * Any ports work. With SER and SRCLK on the same port, as wired, each address
+ * bit costs two stores instead of three.
+ */
+#define BUS_SER SHIFT_DATA
+#define BUS_SRCLK SHIFT_CLK
+#define BUS_RCLK SHIFT_LATCH
+/**
+ * ? Pins to EEPROM
+ * ~OE (Output Enable), ~WE (Write Enable, TIM2_CH2 for the strobe)
+ */
+#define BUS_OE OUTPUT_ENABLE
+#define BUS_WE WRITE_ENABLE
+/**
+ * ? Data Bus
+ * X(bit, label, ...), I/O0 (bit 0) to I/O7 (bit 7). Extra arguments are
+ * passed through to X.
+ */
+#define BUS_DATA_LINES(X, ...) \
+  X(0U, D5, __VA_ARGS__) \
+  X(1U, D6, __VA_ARGS__) \
+  X(2U, D7, __VA_ARGS__) \
+  X(3U, D8, __VA_ARGS__) \
+  X(4U, D9, __VA_ARGS__) \
+  X(5U, D10, __VA_ARGS__) \
+  X(6U, D11, __VA_ARGS__) \
+  X(7U, D12, __VA_ARGS__)
+/**
+ * ? Data Bus Ports
+ * X(port, ...), every port holding at least one data line. The build fails if
+ * a data line is on a port missing here.
+ */
+#define BUS_DATA_PORTS(X, ...) \
+  X(GPIOA, __VA_ARGS__) \
+  X(GPIOB, __VA_ARGS__) \
+  X(GPIOF, __VA_ARGS__)
+
+//* Accessors
+/**
+ * @brief GPIO port and GPIO_PIN_x mask of a pin map entry.
+ */
+#define BUS_PORT(label) BUS_PORT_(label)
+#define BUS_PORT_(label) (label##_GPIO_Port)
+#define BUS_PIN(label) BUS_PIN_(label)
+#define BUS_PIN_(label) ((uint32_t)label##_Pin)
+/**
+ * @brief Position of a pin map entry in its port, folded at compile time.
+ */
+#define BUS_POSITION(label) ((uint8_t)__builtin_ctz(BUS_PIN(label)))
@@ -129,7 +129,6 @@ void circ_buf_write_ov_byte(const circ_buf_handle_t circ_buf, uint8_t data);
  */
 circ_buf_status_t circ_buf_read_byte(const circ_buf_handle_t circ_buf, uint8_t* dest);
 
-#ifdef UNIT_TEST
 /**
  * @brief Prints the head and tail indices of the given circular buffer struct.
  * 
@@ -138,6 +137,8 @@ circ_buf_status_t circ_buf_read_byte(const circ_buf_handle_t circ_buf, uint8_t*
 void dump_indices(const circ_buf_handle_t circ_buf);
 /**
  * @brief Basic memory dump at the given address. All values are printed in hex.
+ * Also used for regular command output, so it prints with printf() rather
+ * than the tokenized debugf().
  * 
  * @param start Pointer to the first byte of memory to print.
  * @param size Size in bytes of memory to print.
@@ -165,5 +166,3 @@ void dump_chars(const uint8_t* start, size_t size, const size_t columns);
   dump_chars(circ_buf_buffer(circ_buf), (circ_buf_size(circ_buf) + 1U), 0x20);
   #endif
  */
-
-#endif /* UNIT_TEST */
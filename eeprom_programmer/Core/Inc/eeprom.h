@@ -10,71 +10,262 @@ typedef enum rw_mode {
   SINGLE_WRITE_MODE,
   MULTI_READ_MODE,
   MULTI_WRITE_MODE,
+  MULTI_READ_RLE_MODE,
+  MULTI_UPDATE_MODE, // Multi-byte write that skips unchanged bytes
 } rw_mode_t;
 
+typedef enum eeprom_status {
+  EEPROM_ERR_VERIFY = -2,
+  EEPROM_ERR_TIMEOUT,
+  EEPROM_OK,
+  EEPROM_BUSY, // Write cycle still running
+} eeprom_status_t;
+
+/**
+ * @brief Method used to detect the end of an internal write cycle.
+ */
+typedef enum write_completion {
+  WRITE_COMPLETION_DELAY, // Fixed tWC delay, for parts without status bits
+  WRITE_COMPLETION_DATA_POLLING, // I/O7 reads the complement of the written bit 7
+  WRITE_COMPLETION_TOGGLE_BIT, // I/O6 toggles on every read
+  WRITE_COMPLETION_COUNT,
+} write_completion_t;
+
+/**
+ * @brief When written bytes are read back and compared.
+ */
+typedef enum verify_mode {
+  VERIFY_OFF,
+  VERIFY_BYTE, // Right after each byte's write cycle
+  VERIFY_BLOCK, // Once after the whole packet, with a single bus turnaround
+  VERIFY_MODE_COUNT,
+} verify_mode_t;
+
+/**
+ * @brief Supported parts, indexing device_profiles.
+ */
+typedef enum device {
+  DEVICE_AT28C16,
+  DEVICE_28C64,
+  DEVICE_28C256,
+  DEVICE_SST39SF010,
+  DEVICE_SST39SF020,
+  DEVICE_SST39SF040,
+  DEVICE_COUNT,
+} device_t;
+
+/**
+ * @brief Geometry and timing of a part. Timing values are the datasheet
+ * worst case of the slowest speed grade.
+ */
+typedef struct device_profile {
+  const char* name;
+  uint8_t address_bits;
+  uint32_t size; // Bytes
+  uint16_t page_size; // Bytes programmed per write cycle, 1 for byte-write-only parts
+  uint16_t t_wp; // ns, Write Enable pulse width
+  uint16_t t_wc; // us, write cycle time
+  uint16_t t_acc; // ns, address to output delay
+  uint16_t t_as; // ns, address setup before Write Enable falls
+  uint16_t t_oe; // ns, Output Enable to output delay
+  uint16_t t_wph; // ns, Write Enable high between two loads, 0 for byte-write-only parts
+  uint16_t t_blc; // us, byte load cycle window of a page or command sequence, 0 for none
+  write_completion_t completion; // Default write completion method
+  uint8_t sdp; // Supports Software Data Protection
+  // NOR flash only
+  uint8_t flash; // Bytes are programmed with a command sequence and erased by sector
+  uint16_t sector_size; // Bytes
+  uint16_t t_se; // ms, sector erase time
+  uint16_t t_sce; // ms, chip erase time
+  uint16_t software_id; // Manufacturer ID (high byte) and device ID (low byte)
+} device_profile_t;
+
+/**
+ * @brief Software Data Protection actions of SDP_INSTRUCTION.
+ */
+typedef enum sdp_action {
+  SDP_UNLOCK,
+  SDP_LOCK,
+  SDP_AUTO_OFF,
+  SDP_AUTO_ON, // Unlock before and relock after every multi-byte write
+  SDP_ACTION_COUNT,
+} sdp_action_t;
+
+/**
+ * @brief No address: the 74HC595 registers are unknown, e.g. after power-up,
+ * or there is no next address to shift.
+ */
+#define EEPROM_ADDRESS_NONE UINT32_MAX
+
+/**
+ * @brief Bus timing of the selected device in DWT cycles, converted from the
+ * profile's nanoseconds by eeprom_set_device().
+ */
+typedef struct bus_timing {
+  uint32_t t_as;
+  uint32_t t_oe;
+  uint32_t t_acc;
+  uint32_t t_wph;
+  uint32_t t_blc;
+} bus_timing_t;
+
 typedef struct eeprom {
-  // Pinout
-  GPIO_TypeDef* data_port;
-  uint16_t data_pin;
-  GPIO_TypeDef* clock_port;
-  uint16_t clock_pin;
-  GPIO_TypeDef* latch_port;
-  uint16_t latch_pin;
   // Control
+  const device_profile_t* device;
   rw_mode_t mode;
+  write_completion_t completion;
+  verify_mode_t verify;
+  uint8_t verify_retries; // Rewrites of a byte that didn't verify
+  uint8_t sdp_auto; // Wrap multi-byte writes in an SDP unlock and relock
   uint16_t addresses[2];
+  // Bus
+  uint32_t latched_address; // Address on the 74HC595 outputs, or EEPROM_ADDRESS_NONE
+  uint32_t shifted_address; // Address in the 74HC595 shift registers, or EEPROM_ADDRESS_NONE
+  bus_timing_t timing;
+  uint32_t latched_at; // timing_now() at the last RCLK pulse
+  uint32_t enabled_at; // timing_now() at the last falling edge of ~OE
+  uint32_t strobed_at; // timing_now() at the end of the last ~WE pulse
 } eeprom_t;
 
 typedef struct eeprom* eeprom_handle_t;
 
-//* Pin Assignment
-/**
- * ? Pins to SN74HC595 Shift Registers
- * D4 // Connect to SER (Serial)
- * D3 // Connect to RCLK (Storage Register Clock)
- * D1 // Connect to SRCLK (Shift Register Clock)
- */
-/**
- * ? Pins to AT28C16 EEPROM
- * D13 // Connect to Write Enable (~WE)
- * A4 // Connect to Output Enable (~OE).
- */
-#define DATA_BUS_PORT(pin) (\
-  (pin) == 0U ? (D5_GPIO_Port) : \
-  (pin) == 1U ? (D6_GPIO_Port) : \
-  (pin) == 2U ? (D7_GPIO_Port) : \
-  (pin) == 3U ? (D8_GPIO_Port) : \
-  (pin) == 4U ? (D9_GPIO_Port) : \
-  (pin) == 5U ? (D10_GPIO_Port) : \
-  (pin) == 6U ? (D11_GPIO_Port) : \
-  (pin) == 7U ? (D12_GPIO_Port) : ((GPIO_TypeDef*)0U)\
-)
-#define DATA_BUS_PIN(pin) (\
-  (pin) == 0U ? (D5_Pin) : \
-  (pin) == 1U ? (D6_Pin) : \
-  (pin) == 2U ? (D7_Pin) : \
-  (pin) == 3U ? (D8_Pin) : \
-  (pin) == 4U ? (D9_Pin) : \
-  (pin) == 5U ? (D10_Pin) : \
-  (pin) == 6U ? (D11_Pin) : \
-  (pin) == 7U ? (D12_Pin) : ((uint16_t)0U)\
-)
+//* Public Variables
+
+extern const device_profile_t device_profiles[DEVICE_COUNT];
 
 //* Public Function Prototypes
+/**
+ * @brief Selects the part in the socket. Its write completion method becomes
+ * the active one, and its bus timing is converted to DWT cycles.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+void eeprom_set_device(eeprom_handle_t eeprom, device_t device);
+/**
+ * @brief Number of bytes reachable by the address bus. Parts with more address
+ * lines than EEPROM_BUS_ADDRESS_BITS are limited to the low window.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return uint32_t 
+ */
+uint32_t eeprom_size(eeprom_handle_t eeprom);
+/**
+ * @brief Number of ASCII-coded hex characters of the highest reachable address.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return uint8_t 
+ */
+uint8_t eeprom_address_digits(eeprom_handle_t eeprom);
 
 void single_read(eeprom_handle_t eeprom);
 
-void single_write(eeprom_handle_t eeprom, uint8_t byte);
+/**
+ * @brief Writes a single byte. Any verify mode other than VERIFY_OFF reads the
+ * byte back.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param byte Byte to write.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1, `EEPROM_ERR_VERIFY`: -2
+ */
+eeprom_status_t single_write(eeprom_handle_t eeprom, uint8_t byte);
 
 void multi_read(eeprom_handle_t eeprom);
 
-void multi_write(eeprom_handle_t eeprom, uint8_t* data);
 /**
- * @brief Shifts the given EEPROM address to the 16-bit address shift register.
+ * @brief Writes the packet to the address range, stopping at the first byte
+ * whose write cycle doesn't complete.
+ * 
+ * In MULTI_UPDATE_MODE, the range is read first and only the bytes that
+ * differ are programmed. The written and skipped byte counts are printed.
  * 
- * - Bits 10-0: The 11-bit target address.
+ * Parts with a page size above 1 are written a page at a time, with a single
+ * write cycle per page.
  * 
- * - Bits 15-11: These 5 unused pins are masked off.
+ * With verify enabled, the addresses that never verified are printed.
+ * 
+ * With sdp_auto set on a device that supports SDP, the write is wrapped in an
+ * SDP unlock and relock.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param data Bytes to write, one per address in the range.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1, `EEPROM_ERR_VERIFY`: -2
+ */
+eeprom_status_t multi_write(eeprom_handle_t eeprom, uint8_t* data);
+/**
+ * @brief Issues the JEDEC Software Data Protection disable sequence, then
+ * waits tWC for it to take effect.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+void sdp_unlock(eeprom_handle_t eeprom);
+/**
+ * @brief Issues the JEDEC Software Data Protection enable sequence, then waits
+ * tWC for it to take effect.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+void sdp_lock(eeprom_handle_t eeprom);
+/**
+ * @brief Erases the NOR flash sector holding the given address to 0xFF, then
+ * waits for completion with toggle bit polling.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+eeprom_status_t flash_erase_sector(eeprom_handle_t eeprom, uint16_t address);
+/**
+ * @brief Erases the whole NOR flash to 0xFF, including the part above the
+ * address bus window, then waits for completion with toggle bit polling.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+eeprom_status_t flash_erase_chip(eeprom_handle_t eeprom);
+/**
+ * @brief Reads the NOR flash software ID.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return Manufacturer ID (high byte) and device ID (low byte).
+ */
+uint16_t flash_read_id(eeprom_handle_t eeprom);
+/**
+ * @brief Loads up to one page (or a single NOR flash byte) and returns without
+ * waiting for the write cycle. All bytes MUST be in the same page. A page may
+ * be loaded in several calls, as long as each starts within tBLC of the last.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled. Doesn't log,
+ * since it runs in the write engine's interrupt.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param data Bytes to write, starting at address.
+ * @param size Number of bytes, at most the device's page size.
+ * @return uint8_t 1 if a load started more than tBLC after the previous one
+ */
+uint8_t eeprom_load_page(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, uint16_t size);
+/**
+ * @brief Checks once whether the write cycle started by eeprom_load_page() is
+ * complete. WRITE_COMPLETION_DELAY always reports complete, so the caller
+ * must time tWC itself.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param byte Last byte loaded.
+ * @return `EEPROM_OK`: 0, `EEPROM_BUSY`: 1
+ */
+eeprom_status_t eeprom_poll_write(eeprom_handle_t eeprom, uint8_t byte);
+/**
+ * @brief Reads the address range like multi_read(), but collapses every run of
+ * at least RLE_RUN_THRESHOLD identical bytes into a single token.
+ * 
+ * - Literal byte: ` xHH`
+ * 
+ * - Run: ` xHH*NNN`, where NNN is the run length in ASCII-coded hex.
+ * 
+ * Each row starts with the absolute address of its first token.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+void multi_read_rle(eeprom_handle_t eeprom);
+/**
+ * @brief Shifts the given EEPROM address to the 16-bit address shift register.
+ * Address bits above the size of the active device are masked off. Nothing is
+ * shifted when the address is already latched, and only RCLK is pulsed when
+ * it was shifted ahead by prefetch_address().
  * @param eeprom Pointer to an EEPROM instance.
  */
 void set_address(eeprom_handle_t eeprom, uint16_t address);
+/**
+ * @brief Shifts the next address of a sequential access into the shift
+ * registers without latching it. The address lines keep the current address,
+ * so this overlaps the read or write in progress.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+void prefetch_address(eeprom_handle_t eeprom, uint16_t address);
@@ -0,0 +1,130 @@
+/**
+ * @brief Tokenized, deferred logging. Log statements do not format any text
+ * on the device. Instead, each statement queues a compact binary record made
+ * of a format-string ID and the raw 32-bit arguments, which is transmitted
+ * later by log_flush(). The host-side decoder (tools/log_decode.py) recovers
+ * the format strings from the `.log_fmt` section of the ELF and rebuilds the
+ * original text.
+ *
+ * @file log.h
+ */
+#pragma once
+
+#include <stdint.h>
+
+//* Log Levels
+
+#define LOG_LEVEL_NONE 0U
+#define LOG_LEVEL_ERROR 1U
+#define LOG_LEVEL_WARN 2U
+#define LOG_LEVEL_INFO 3U
+#define LOG_LEVEL_DEBUG 4U
+
+/**
+ * @brief Compile-time log level. Statements above this level compile to
+ * nothing, and their format strings are left out of the ELF.
+ */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif /* LOG_LEVEL */
+
+//* Record Format
+/**
+ * ? Record Layout (little-endian)
+ * [0] LOG_RECORD_SYNC
+ * [1] Length of the rest of the record (before escaping)
+ * [2] Bits 7-4: Log level, Bits 3-0: Argument count
+ * [3] Format-string ID (low byte)
+ * [4] Format-string ID (high byte)
+ * [5...] Arguments, 4 bytes each
+ *
+ * ? Escaping
+ * Every byte after the sync byte that is CR, LF, LOG_RECORD_SYNC or
+ * LOG_RECORD_ESC is sent as LOG_RECORD_ESC followed by the byte XOR
+ * LOG_RECORD_ESC_XOR. A line-oriented host never sees a line break inside a
+ * record, and a sync byte always starts a record.
+ */
+/**
+ * @brief ASCII Record Separator. Never part of the ASCII-coded responses, so
+ * the decoder can pick records out of the regular UART stream.
+ */
+#define LOG_RECORD_SYNC 0x1EU
+/**
+ * @brief ASCII Unit Separator. Never part of the ASCII-coded responses either.
+ */
+#define LOG_RECORD_ESC 0x1FU
+#define LOG_RECORD_ESC_XOR 0x20U
+#define LOG_RECORD_HEADER_SIZE 5U
+#define LOG_ARGS_MAX 8U
+#define LOG_RECORD_SIZE_MAX (LOG_RECORD_HEADER_SIZE + (LOG_ARGS_MAX * 4U))
+/**
+ * @brief Size (in bytes) of the queue holding records until log_flush().
+ */
+#define LOG_BUF_SIZE 256U
+
+//* Private Macros
+
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+/**
+ * @brief Counts 0 to LOG_ARGS_MAX variadic arguments.
+ */
+#define LOG_NARGS(...) LOG_NARGS_(_0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+/**
+ * @brief Places the format string in the non-allocated `.log_fmt` section.
+ * The string never reaches flash, and its offset in the section is its ID.
+ */
+#define LOG_RECORD(level, fmt, ...) do { \
+  static const char log_fmt[] __attribute__((section(".log_fmt"), used)) = fmt; \
+  log_write((level), (uint16_t)(uintptr_t)log_fmt, LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__); \
+} while (0)
+
+//* Public Log Macros
+/**
+ * @brief Only integer conversions (%d, %u, %X, %c, ...) are supported since
+ * arguments are sent as raw 32-bit words. %s and %f are NOT supported.
+ */
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+  #define LOG_ERROR(fmt, ...) LOG_RECORD(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+  #define LOG_ERROR(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+  #define LOG_WARN(fmt, ...) LOG_RECORD(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+  #define LOG_WARN(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+  #define LOG_INFO(fmt, ...) LOG_RECORD(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+  #define LOG_INFO(fmt, ...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+  #define LOG_DEBUG(fmt, ...) LOG_RECORD(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+  #define LOG_DEBUG(fmt, ...) do {} while (0)
+#endif
+
+//* Public Function Prototypes
+/**
+ * @brief Allocates the record queue. Records logged before this call are
+ * dropped.
+ */
+void log_init(void);
+/**
+ * @brief Escapes and queues one record. Called through the LOG_* macros only.
+ * If the queue is full, the whole record is dropped rather than sending a
+ * partial record.
+ *
+ * @param level One of LOG_LEVEL_ERROR to LOG_LEVEL_DEBUG.
+ * @param id Offset of the format string in the `.log_fmt` section.
+ * @param argc Number of 32-bit arguments that follow.
+ */
+void log_write(uint8_t level, uint16_t id, uint8_t argc, ...);
+/**
+ * @brief Transmits all queued records over UART. Call from the main loop
+ * between commands so logging never stalls a bus operation.
+ */
+void log_flush(void);
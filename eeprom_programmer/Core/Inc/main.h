@@ -77,11 +77,92 @@ extern "C" {
 #define UART_PACKET_SIZE (DATA_PACKET_SIZE * (ACH_SIZE + sizeof(char)))
 
 #define PACKET_POLLING_RATE 4U // Hz
+/**
+ * @brief Shortest run of identical bytes that is sent as a single RLE token by
+ * the compressed read. A run token (` xHH*NNN`) is 8 characters, while each
+ * literal byte (` xHH`) is 4, so shorter runs are sent as literals.
+ */
+#define RLE_RUN_THRESHOLD 3U
+/**
+ * @brief Number of RLE tokens per row of the compressed read output.
+ */
+#define RLE_COLUMNS 0x20U
+
+/**
+ * @brief Baud rates are sent as 6-character ASCII-coded hex, e.g. 0F4240 for
+ * 1,000,000 baud.
+ */
+#define BAUD_RATE_CODED_SIZE 6U
+#define BAUD_RATE_MIN 1200U
+/**
+ * @brief Time the host has to send BAUD_CONFIRM_INSTRUCTION at the new baud
+ * rate before the device reverts to BAUD_RATE.
+ */
+#define BAUD_CONFIRM_TIMEOUT 2000U // ms
+/**
+ * @brief Time to wait at startup for the host's first packet to detect its
+ * baud rate. The device falls back to BAUD_RATE if nothing arrives.
+ */
+#define AUTOBAUD_TIMEOUT 3000U // ms
 
 #define EEPROM_START_ADDRESS 0U
+/**
+ * @brief Address lines driven by the two SN74HC595 shift registers.
+ */
+#define EEPROM_BUS_ADDRESS_BITS 16U
+/**
+ * @brief Write completion polling gives up after this many times the device's
+ * tWC (plus one tick).
+ */
+#define EEPROM_WRITE_TIMEOUT_FACTOR 2U
+/**
+ * @brief Devices are selected by their index in device_profiles, sent as
+ * 2-character ASCII-coded hex.
+ */
+#define DEVICE_CODED_SIZE ACH_SIZE
+/**
+ * @brief Software Data Protection actions are sent as 2-character ASCII-coded
+ * hex.
+ */
+#define SDP_CODED_SIZE ACH_SIZE
+/**
+ * @brief Interrupts at this NVIC priority or lower are held off while a page
+ * or command sequence is loaded. The UART and SysTick interrupts run at
+ * priority 0 and are short enough to fit within tBLC, so bytes keep arriving
+ * while the write engine programs in the background.
+ */
+#define BUS_CRITICAL_PRIORITY 1U
+/**
+ * @brief Time (tIDA) for the NOR flash to enter or leave software ID mode.
+ */
+#define FLASH_ID_ACCESS_TIME 150U // ns
+/**
+ * @brief Verify settings are sent as 4-character ASCII-coded hex: the verify
+ * mode in the upper byte and the retry count in the lower byte, e.g. 0103 for
+ * per-byte verify with 3 retries.
+ */
+#define VERIFY_CODED_SIZE 4U
+/**
+ * @brief Number of failing addresses listed in a verify report. Any further
+ * failures are only counted.
+ */
+#define VERIFY_FAILURES_MAX 16U
 
-#define EEPROM_ADDRESS_SIZE 2048U // Bytes
-#define EEPROM_ADDRESS_MAX (EEPROM_ADDRESS_SIZE - 1U) // Bytes
+//* Address Bus Backends
+/**
+ * ? GPIO: SER and SRCLK bit-banged on SHIFT_DATA (PA4) and SHIFT_CLK (PA1).
+ * ? SPI: SER and SRCLK driven by SPI1 as a single 16-bit frame, which needs
+ * the board rewired: SRCLK to SPI1_SCK (PA5, A4), SER to SPI1_MOSI (PA7, A6)
+ * and ~OE moved from PA5 to PA0 (A0). RCLK stays on SHIFT_LATCH (PA3).
+ */
+#define BUS_ADDRESS_GPIO 0U
+#define BUS_ADDRESS_SPI 1U
+/**
+ * @brief Compile-time address bus backend.
+ */
+#ifndef BUS_ADDRESS_BACKEND
+#define BUS_ADDRESS_BACKEND BUS_ADDRESS_GPIO
+#endif /* BUS_ADDRESS_BACKEND */
 
 /* USER CODE END EM */
 
@@ -130,6 +211,15 @@ void Error_Handler(void);
 #define D5_GPIO_Port GPIOB
 
 /* USER CODE BEGIN Private defines */
+#if BUS_ADDRESS_BACKEND == BUS_ADDRESS_SPI
+#define ADDRESS_SCK_Pin GPIO_PIN_5
+#define ADDRESS_SCK_GPIO_Port GPIOA
+#define ADDRESS_MOSI_Pin GPIO_PIN_7
+#define ADDRESS_MOSI_GPIO_Port GPIOA
+// SPI1_SCK takes PA5, so ~OE moves to PA0. MX_GPIO_Init() picks this up.
+#undef OUTPUT_ENABLE_Pin
+#define OUTPUT_ENABLE_Pin GPIO_PIN_0
+#endif /* BUS_ADDRESS_BACKEND */
 
 /* USER CODE END Private defines */
 
@@ -1,38 +1,40 @@
 #pragma once
 
 #include "main.h"
+#include "log.h"
 #include <string.h>
 #include <stdio.h>
 
-#define PRINTF_TIMEOUT 50
+#define PRINTF_TIMEOUT 50 // ms, on top of the time needed to send the frame
 #define PRINTF_BUF_SIZE 1024
 
 extern UART_HandleTypeDef huart2;
-extern char printf_buffer[PRINTF_BUF_SIZE];
 /**
- * @brief Redirect printf to UART Tx. Use uint8_t instead of char. Note, the %z
- * format specifier isn't supported.
+ * @brief Redirect printf to the response frame. Output is NOT sent until
+ * print_flush() is called, or the frame fills up. Use uint8_t instead of char.
+ * Note, the %z format specifier isn't supported.
  */
-#define printf(...) \
-sprintf(printf_buffer, __VA_ARGS__); \
-HAL_UART_Transmit(&huart2, (uint8_t*)printf_buffer, (uint16_t)strlen(printf_buffer), PRINTF_TIMEOUT);
+#define printf(...) print_append(__VA_ARGS__)
+
+//* Public Function Prototypes
+/**
+ * @brief Formats text onto the end of the response frame. If the text doesn't
+ * fit, the frame is flushed first.
+ */
+void print_append(const char* format, ...) __attribute__((format(printf, 1, 2)));
+/**
+ * @brief Sends the whole response frame as a single UART transfer, then
+ * empties it. The main loop calls this once per state handler, so the output
+ * of one command goes out as one contiguous frame.
+ */
+void print_flush(void);
 
 //* Debugging
 
 /**
- * @brief Comment out UNIT_TEST below to disable all debug-specific UART prints.
+ * @brief Debug prints are tokenized log records (see log.h). No formatting or
+ * blocking transmit happens at the call site, and they compile out entirely
+ * when LOG_LEVEL is below LOG_LEVEL_DEBUG. Define UNIT_TEST (-DUNIT_TEST) to
+ * additionally echo every parsed data packet back over UART.
  */
-#ifndef UNIT_TEST
-#define UNIT_TEST
-#endif /* UNIT_TEST */
-
-#ifdef UNIT_TEST
-  /**
-  * @brief Redirect printf to UART Tx. Note %z format modifier isn't supported.
-  */
-  #define debugf(...) \
-  sprintf(printf_buffer, __VA_ARGS__); \
-  HAL_UART_Transmit(&huart2, (uint8_t*)printf_buffer, (uint16_t)strlen(printf_buffer), PRINTF_TIMEOUT);
-#else
-  #define debugf(...)
-#endif /* UNIT_TEST */
+#define debugf(...) LOG_DEBUG(__VA_ARGS__)
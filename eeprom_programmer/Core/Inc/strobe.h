@@ -0,0 +1,37 @@
+/**
+ * @brief Write Enable strobe generated by hardware. WRITE_ENABLE (PB3) is
+ * driven by TIM2_CH2 in one-pulse mode, so the width of the ~WE pulse is set
+ * in timer ticks instead of depending on how long two GPIO register writes
+ * happen to take at the current core clock.
+ *
+ * TIM2 is also used by autobaud_detect() at startup, so strobe_init() MUST be
+ * called after it.
+ *
+ * @file strobe.h
+ */
+#pragma once
+
+#include "main.h"
+#include <stdint.h>
+
+//* Public Function Prototypes
+/**
+ * @brief Sets up TIM2_CH2 for active-low one-pulse output and hands
+ * WRITE_ENABLE over to it. The pin stays high until the first pulse.
+ * @param width Pulse width (in ns).
+ */
+void strobe_init(uint32_t width);
+/**
+ * @brief Sets the pulse width, rounded up to whole timer ticks. Must not be
+ * called during a pulse.
+ * @param width Pulse width (in ns).
+ */
+void strobe_set_width(uint32_t width);
+/**
+ * @brief Starts a single ~WE pulse and returns right away.
+ */
+void strobe_start(void);
+/**
+ * @brief Waits for the pulse started by strobe_start() to end.
+ */
+void strobe_wait(void);
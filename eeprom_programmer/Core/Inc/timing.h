@@ -0,0 +1,89 @@
+/**
+ * @brief Sub-microsecond bus timing from the DWT cycle counter. CYCCNT counts
+ * core clock cycles (62.5 ns at 16 MHz) and wraps every 268 s, so a timestamp
+ * and an unsigned subtraction time any bus interval without a timer.
+ *
+ * Delays are measured from the edge they are specified against: a wait only
+ * spins for whatever part of the interval the code since that edge has not
+ * already used up. Datasheet minimums are converted to cycles once, when the
+ * device is selected, so a wait that is already over costs a single compare.
+ *
+ * @file timing.h
+ */
+#pragma once
+
+#include "main.h"
+#include <stdint.h>
+
+//* Compile-Time Timing
+/**
+ * @brief Core clock set by SystemClock_Config() (HSI / 2 x PLL x4). Raising
+ * the clock means raising this too, so compile-time waits grow with it.
+ * timing_init() asserts that the clock is not above it.
+ */
+#define TIMING_CORE_CLOCK_HZ 16000000U
+/**
+ * @brief Converts a constant time to core clock cycles at compile time,
+ * rounded up like timing_cycles().
+ */
+#define TIMING_CYCLES(ns) \
+  ((uint32_t)((((uint64_t)(ns) * TIMING_CORE_CLOCK_HZ) + 999999999ULL) / 1000000000ULL))
+/**
+ * @brief Waits at least `ns`, a constant, between two GPIO stores. Stores are
+ * at least a cycle apart, so the wait compiles to nothing while `ns` fits in a
+ * cycle, e.g. every 74HC595 minimum at 16 MHz.
+ */
+#define TIMING_HOLD(ns) \
+  do { \
+    if (TIMING_CYCLES(ns) > 1U) { \
+      timing_delay(TIMING_CYCLES(ns) - 1U); \
+    } \
+  } while (0)
+
+/**
+ * ? SN74HC595 Minimums (4.5 V, -40 to 85 C)
+ * T_SU: SER before SRCLK rising, and SRCLK rising before RCLK rising
+ * T_W: SRCLK or RCLK pulse width, high or low
+ */
+#define TIMING_HC595_T_SU 25U // ns
+#define TIMING_HC595_T_W 20U  // ns
+
+//* Public Function Prototypes
+/**
+ * @brief Enables the DWT cycle counter. Called once before any bus access,
+ * after the system clock is set up.
+ */
+void timing_init(void);
+/**
+ * @brief Converts a time to core clock cycles, rounded up so a delay is never
+ * shorter than the datasheet minimum.
+ * @param ns Time (in ns).
+ * @return uint32_t Cycles
+ */
+uint32_t timing_cycles(uint32_t ns);
+
+//* Public Inline Functions
+/**
+ * @brief Timestamp of the current cycle.
+ * @return uint32_t CYCCNT
+ */
+__STATIC_FORCEINLINE uint32_t timing_now(void) {
+  return DWT->CYCCNT;
+}
+/**
+ * @brief Waits until at least `cycles` have passed since `stamp`. Returns
+ * right away if they already have.
+ * @param stamp Timestamp from timing_now().
+ * @param cycles Interval from timing_cycles().
+ */
+__STATIC_FORCEINLINE void timing_wait(uint32_t stamp, uint32_t cycles) {
+  while ((DWT->CYCCNT - stamp) < cycles) {
+  }
+}
+/**
+ * @brief Waits for at least `cycles` from now.
+ * @param cycles Interval from timing_cycles().
+ */
+__STATIC_FORCEINLINE void timing_delay(uint32_t cycles) {
+  timing_wait(DWT->CYCCNT, cycles);
+}
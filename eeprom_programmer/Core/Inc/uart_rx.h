@@ -11,6 +11,17 @@ typedef enum instruction_code {
   SINGLE_WRITE_INSTRUCTION = 'b', // Write Byte
   MULTI_READ_INSTRUCTION = 'r',
   MULTI_WRITE_INSTRUCTION = 'w',
+  MULTI_READ_RLE_INSTRUCTION = 'c', // Compressed Read
+  MULTI_UPDATE_INSTRUCTION = 'u', // Write Changed Bytes Only
+  SET_BAUD_INSTRUCTION = 's',
+  BAUD_CONFIRM_INSTRUCTION = 'y', // Sent by the host at the new baud rate
+  WRITE_COMPLETION_INSTRUCTION = 'm', // Write Completion Method
+  VERIFY_INSTRUCTION = 'v', // Verify Mode and Retries
+  DEVICE_INSTRUCTION = 'd', // Select Device Profile
+  SDP_INSTRUCTION = 'p', // Software Data Protection
+  SECTOR_ERASE_INSTRUCTION = 'e', // NOR Flash Sector Erase
+  CHIP_ERASE_INSTRUCTION = 'x', // NOR Flash Chip Erase
+  SOFTWARE_ID_INSTRUCTION = 'i', // NOR Flash Software ID
 } instruction_code_t;
 
 typedef enum status {
@@ -37,6 +48,17 @@ uart_rx_status_t uart_rx_parse_instruction(const uart_rx_handle_t uart_rx, const
 uart_rx_status_t uart_rx_parse_address(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, eeprom_handle_t eeprom, uart_rx_status_t status);
 
 uart_rx_status_t uart_rx_parse_data(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, uart_rx_status_t status);
+/**
+ * @brief Parses a packet holding a single ASCII-coded hex argument of exactly
+ * coded_size characters, e.g. the baud rate of SET_BAUD_INSTRUCTION.
+ */
+uart_rx_status_t uart_rx_parse_argument(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, size_t* argument, uint8_t coded_size);
+
+/**
+ * @brief Sets the number of ASCII-coded hex characters of every address, to
+ * match the active device.
+ */
+void uart_rx_set_address_size(const uart_rx_handle_t uart_rx, uint8_t coded_size);
 
 void uart_rx_clear(const uart_rx_handle_t uart_rx);
 
@@ -0,0 +1,86 @@
+/**
+ * @brief Background write engine. Multi-byte writes are queued and programmed
+ * from the TIM6 update interrupt, one step per tick: load a part of a page,
+ * poll its write cycle, move on to the next page. The main loop keeps receiving and
+ * parsing the next packet meanwhile, so programming an image takes about as
+ * long as the slower of the transfer and the programming, rather than both.
+ *
+ * Nothing else may drive the bus while the engine is busy. Every command that
+ * accesses the bus calls write_engine_flush() first.
+ *
+ * @file write_engine.h
+ */
+#pragma once
+
+#include "eeprom.h"
+#include "main.h"
+#include <stdint.h>
+
+/**
+ * @brief Number of packets that can be queued. One is programmed while the
+ * next one is received.
+ */
+#define WRITE_ENGINE_QUEUE_SIZE 2U
+/**
+ * @brief Time (in us) between two steps of the engine. One step is a partial
+ * page load or a single poll of the write cycle.
+ */
+#define WRITE_ENGINE_TICK 50U // us
+/**
+ * @brief Bytes loaded per step, bounding the time spent in the interrupt to a
+ * few byte loads. Consecutive steps start one tick apart, well within the
+ * tBLC of the page-write parts.
+ */
+#define WRITE_ENGINE_LOAD_MAX 8U
+/**
+ * @brief NVIC priority of TIM6. Below the UART, so no byte is dropped while a
+ * page is loaded.
+ */
+#define WRITE_ENGINE_IRQ_PRIORITY 2U
+
+//* Public Typedefs
+
+typedef enum write_engine_status {
+  WRITE_ENGINE_ERR_FULL = -1,
+  WRITE_ENGINE_OK,
+} write_engine_status_t;
+
+//* Public Function Prototypes
+/**
+ * @brief Sets up TIM6. The timer only runs while packets are queued.
+ * @param eeprom Pointer to the EEPROM instance to program.
+ */
+void write_engine_init(eeprom_handle_t eeprom);
+/**
+ * @brief Copies a packet to the queue and starts programming it in the
+ * background.
+ * @param address Address of the first byte.
+ * @param data Bytes to write, one per address.
+ * @param size Number of bytes, at most DATA_PACKET_SIZE.
+ * @return `WRITE_ENGINE_OK`: 0, `WRITE_ENGINE_ERR_FULL`: -1
+ */
+write_engine_status_t write_engine_enqueue(uint16_t address, const uint8_t* data, uint16_t size);
+/**
+ * @brief Waits until every queued packet is programmed.
+ */
+void write_engine_flush(void);
+/**
+ * @brief Returns and clears the first error since the last call. Programming
+ * stops at a write cycle that doesn't complete, and the rest of the queue is
+ * dropped.
+ * @param address Receives the address of the failed write cycle.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+eeprom_status_t write_engine_result(uint16_t* address);
+/**
+ * @brief Returns and clears whether a page load has been late since the last
+ * call: a byte started more than tBLC after the previous one, so the page may
+ * have been split over two write cycles.
+ * @param address Receives the address of the first late page.
+ * @return uint8_t 1 if late
+ */
+uint8_t write_engine_late(uint16_t* address);
+/**
+ * @brief Runs one step of the engine. Called from TIM6_DAC1_IRQHandler().
+ */
+void write_engine_irq_handler(void);
@@ -0,0 +1,188 @@
+/**
+ * @brief Source C file of the automatic baud rate detection.
+ * @file autobaud.c
+ */
+#include "autobaud.h"
+#include "main.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief TIM2_CH1 capture times of every edge on VCP_RX, filled by DMA1
+ * Channel 5. Edges alternate, starting with the falling edge of a start bit,
+ * so falling edges have even indices and rising edges have odd indices.
+ */
+static uint32_t edges[AUTOBAUD_EDGES_MAX];
+
+static const uint32_t standard_baud_rates[] = {
+  1200U, 2400U, 4800U, 9600U, 14400U, 19200U, 38400U, 57600U, 115200U,
+  230400U, 460800U, 921600U, 1000000U, 1500000U, 2000000U,
+};
+
+//* Private Function Prototypes
+
+static void capture_start(void);
+static void capture_stop(void);
+static uint32_t timer_clock(void);
+static uint8_t line_level(size_t count, uint32_t time);
+static uint32_t snap_baud_rate(uint32_t baud_rate);
+
+//* Public Functions
+
+uint32_t autobaud_detect(uint32_t timeout, uint8_t* rx, size_t* rx_len) {
+  assert_param(rx && rx_len); // Ensure destinations
+
+  const size_t rx_size = *rx_len;
+  *rx_len = 0U;
+
+  capture_start();
+
+  // Wait for the start bit of the first character
+  const uint32_t tick = HAL_GetTick();
+  while (DMA1_Channel5->CNDTR == AUTOBAUD_EDGES_MAX) {
+    if ((HAL_GetTick() - tick) > timeout) {
+      capture_stop();
+      return 0U;
+    }
+  }
+
+  // Capture until the line has been idle for two frames at the slowest rate
+  const uint32_t idle = (2U * 10U * timer_clock()) / BAUD_RATE_MIN;
+  size_t count = 0U;
+  do {
+    count = AUTOBAUD_EDGES_MAX - DMA1_Channel5->CNDTR;
+  } while ((count < AUTOBAUD_EDGES_MAX) && ((TIM2->CNT - edges[count - 1U]) < idle));
+  count = AUTOBAUD_EDGES_MAX - DMA1_Channel5->CNDTR;
+  capture_stop();
+  if (count < 2U) {
+    return 0U;
+  }
+
+  // Estimate the bit time from the shortest gap. Most characters have a
+  // single-bit run, but not all (0x3C doesn't), so only the frame check below
+  // makes the estimate safe.
+  uint32_t bit = UINT32_MAX;
+  for (size_t i = 1U; i < count; ++i) {
+    if ((edges[i] - edges[i - 1U]) < bit) {
+      bit = edges[i] - edges[i - 1U];
+    }
+  }
+
+  // Refine: the stop bit rises 9 bit times after the start bit
+  uint32_t frame = 0U; // 9 bit times
+  uint32_t error = UINT32_MAX;
+  for (size_t i = 1U; i < count; i += 2U) {
+    const uint32_t span = edges[i] - edges[0];
+    const uint32_t diff = (span > (9U * bit)) ? (span - (9U * bit)) : ((9U * bit) - span);
+    if (diff < error) {
+      error = diff;
+      frame = span;
+    }
+  }
+  if ((frame == 0U) || (error > (bit / 2U))) {
+    return 0U;
+  }
+
+  // Decode each character by sampling the middle of every data bit. A full
+  // capture can end inside a character, which is dropped, since its stop bit
+  // never rose.
+  const uint8_t full = (count == AUTOBAUD_EDGES_MAX);
+  size_t start = 0U;
+  while ((start < count) && (*rx_len < rx_size)) {
+    if (full && ((int32_t)(edges[count - 1U] - (edges[start] + ((frame * 17U) / 18U))) < 0)) {
+      break;
+    }
+    uint8_t ch = 0U;
+    for (uint8_t i = 0U; i < 8U; ++i) {
+      const uint32_t sample = edges[start] + ((frame * ((2U * i) + 3U)) / 18U);
+      ch |= (line_level(count, sample) << i);
+    }
+    rx[(*rx_len)++] = ch;
+
+    // Next start bit is the first falling edge after this stop bit
+    const uint32_t stop = edges[start] + ((frame * 19U) / 18U);
+    do {
+      start += 2U;
+    } while ((start < count) && ((int32_t)(edges[start] - stop) < 0));
+  }
+
+  return snap_baud_rate((uint32_t)(((uint64_t)timer_clock() * 9U) / frame));
+}
+
+//* Private Helper Functions
+
+static void capture_start(void) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_TIM2_CLK_ENABLE();
+  __HAL_RCC_DMA1_CLK_ENABLE();
+
+  // Route VCP_RX to TIM2_CH1, idle high like the UART line
+  GPIO_InitStruct.Pin = VCP_RX_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_PULLUP;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStruct.Alternate = GPIO_AF1_TIM2;
+  HAL_GPIO_Init(VCP_RX_GPIO_Port, &GPIO_InitStruct);
+
+  // DMA1 Channel 5 (TIM2_CH1): TIM2->CCR1 to edges[], 32-bit words
+  DMA1_Channel5->CCR = 0U;
+  DMA1_Channel5->CPAR = (uint32_t)&TIM2->CCR1;
+  DMA1_Channel5->CMAR = (uint32_t)edges;
+  DMA1_Channel5->CNDTR = AUTOBAUD_EDGES_MAX;
+  DMA1_Channel5->CCR = DMA_CCR_MINC | DMA_CCR_PSIZE_1 | DMA_CCR_MSIZE_1 | DMA_CCR_PL | DMA_CCR_EN;
+
+  // Free-running 32-bit counter at the full timer clock, capture on both edges of TI1
+  TIM2->CR1 = 0U;
+  TIM2->PSC = 0U;
+  TIM2->ARR = UINT32_MAX;
+  TIM2->CCMR1 = TIM_CCMR1_CC1S_0;
+  TIM2->CCER = TIM_CCER_CC1P | TIM_CCER_CC1NP | TIM_CCER_CC1E;
+  TIM2->DIER = TIM_DIER_CC1DE;
+  TIM2->EGR = TIM_EGR_UG;
+  TIM2->SR = 0U;
+  TIM2->CR1 = TIM_CR1_CEN;
+}
+
+static void capture_stop(void) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  DMA1_Channel5->CCR = 0U;
+  __HAL_RCC_TIM2_FORCE_RESET();
+  __HAL_RCC_TIM2_RELEASE_RESET();
+  __HAL_RCC_TIM2_CLK_DISABLE();
+
+  // Give VCP_RX back to USART2
+  GPIO_InitStruct.Pin = VCP_RX_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStruct.Alternate = GPIO_AF7_USART2;
+  HAL_GPIO_Init(VCP_RX_GPIO_Port, &GPIO_InitStruct);
+}
+
+static uint32_t timer_clock(void) {
+  // APB1 timers run at twice PCLK1 whenever APB1 is divided
+  const uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+  return (RCC->CFGR & RCC_CFGR_PPRE1_2) ? (2U * pclk1) : pclk1;
+}
+
+static uint8_t line_level(size_t count, uint32_t time) {
+  // The line starts high and every captured edge toggles it
+  size_t toggles = 0U;
+  while ((toggles < count) && ((int32_t)(time - edges[toggles]) >= 0)) {
+    ++toggles;
+  }
+  return !(toggles & 1U);
+}
+
+static uint32_t snap_baud_rate(uint32_t baud_rate) {
+  for (size_t i = 0U; i < (sizeof(standard_baud_rates) / sizeof(standard_baud_rates[0])); ++i) {
+    const uint32_t standard = standard_baud_rates[i];
+    const uint32_t diff = (baud_rate > standard) ? (baud_rate - standard) : (standard - baud_rate);
+    if ((diff * 100U) <= (standard * AUTOBAUD_STANDARD_TOLERANCE)) {
+      return standard;
+    }
+  }
+  return baud_rate;
+}
@@ -0,0 +1,217 @@
+/**
+ * @brief Source C file of the data and address bus primitives. Everything
+ * pin-specific is generated from the pin map in bus_pins.h.
+ * @file bus.c
+ */
+#include "bus.h"
+#include "bus_pins.h"
+#include "main.h"
+#include "timing.h"
+#include <stdint.h>
+
+//* Generated Data Bus Accessors
+/**
+ * @brief Index of a data port, BUS_GPIOA, BUS_GPIOB, ...
+ */
+#define PORT_ENUM(port, ...) BUS_##port,
+/**
+ * @brief Index of the port holding a data line.
+ */
+#define PORT_INDEX_TERM(port, label) + ((BUS_PORT(label) == (port)) ? (uint32_t)BUS_##port : 0U)
+#define PORT_INDEX(label) (0U BUS_DATA_PORTS(PORT_INDEX_TERM, label))
+/**
+ * @brief Fails the build if a data line's port is missing from BUS_DATA_PORTS,
+ * which PORT_INDEX() would otherwise silently map to the first port.
+ */
+#define PORT_LISTED_TERM(port, label) || (BUS_PORT(label) == (port))
+#define ASSERT_PORT_LISTED(bit, label, ...) \
+  _Static_assert(0 BUS_DATA_PORTS(PORT_LISTED_TERM, label), #label " is on a port missing from BUS_DATA_PORTS");
+
+#define SAMPLE_PORT(port, ...) idr[BUS_##port] = (port)->IDR;
+#define GATHER_BIT(bit, label, ...) | (((idr[PORT_INDEX(label)] >> BUS_POSITION(label)) & 1U) << (bit))
+#define READ_BIT_CASE(bit, label, ...) \
+  case (bit): \
+    return (uint8_t)((BUS_PORT(label)->IDR >> BUS_POSITION(label)) & 1U);
+
+/**
+ * @brief BSRR word presenting `byte` on the data lines of `port`: set bits of
+ * the byte go to the low half, clear bits to the reset half.
+ */
+#define BSRR_TERM(bit, label, port, byte) \
+  | ((BUS_PORT(label) == (port)) ? ((((byte) >> (bit)) & 1U) ? BUS_PIN(label) : (BUS_PIN(label) << 16U)) : 0U)
+#define BSRR_WORD(port, byte) (0U BUS_DATA_LINES(BSRR_TERM, port, byte)),
+#define BSRR_ENTRY(byte) {BUS_DATA_PORTS(BSRR_WORD, byte)}
+#define BSRR_ENTRIES_4(byte) BSRR_ENTRY(byte), BSRR_ENTRY((byte) + 1U), BSRR_ENTRY((byte) + 2U), BSRR_ENTRY((byte) + 3U)
+#define BSRR_ENTRIES_16(byte) BSRR_ENTRIES_4(byte), BSRR_ENTRIES_4((byte) + 4U), BSRR_ENTRIES_4((byte) + 8U), BSRR_ENTRIES_4((byte) + 12U)
+#define BSRR_ENTRIES_64(byte) BSRR_ENTRIES_16(byte), BSRR_ENTRIES_16((byte) + 16U), BSRR_ENTRIES_16((byte) + 32U), BSRR_ENTRIES_16((byte) + 48U)
+#define WRITE_PORT(port, bsrr) (port)->BSRR = (bsrr)[BUS_##port];
+
+/**
+ * @brief MODER bits of every data line on `port`, `mode` being the 2-bit
+ * value of a single pin.
+ */
+#define MODER_TERM(bit, label, port, mode) \
+  | ((BUS_PORT(label) == (port)) ? ((uint32_t)(mode) << (2U * BUS_POSITION(label))) : 0U)
+#define MODER_MASK(port, mode) (0U BUS_DATA_LINES(MODER_TERM, port, mode))
+#define SET_MODER(port, output) \
+  (port)->MODER = ((port)->MODER & ~MODER_MASK(port, GPIO_MODER_MODER0)) | ((output) ? MODER_MASK(port, GPIO_MODER_MODER0_0) : 0U);
+
+//* Generated Address Accessors
+
+#if BUS_ADDRESS_BACKEND == BUS_ADDRESS_SPI
+#define BUS_SPI SPI1
+#endif /* BUS_ADDRESS_BACKEND */
+
+/**
+ * @brief Presents one address bit on SER while pulling SRCLK low, then raises
+ * SRCLK. The bit picks the set or the reset half of SER's BSRR word with a
+ * shift instead of a branch. When SER and SRCLK share a port, the first two
+ * edges are a single store. The 74HC595 setup and pulse width minimums are
+ * held with TIMING_HOLD(), which is empty at 16 MHz.
+ */
+#define SER_WORD(word, bit) ((BUS_PIN(BUS_SER) << 16U) >> ((((word) >> (bit)) & 1U) << 4U))
+#define SHIFT_BIT(word, bit) \
+  do { \
+    if (BUS_PORT(BUS_SER) == BUS_PORT(BUS_SRCLK)) { \
+      BUS_PORT(BUS_SRCLK)->BSRR = SER_WORD(word, bit) | (BUS_PIN(BUS_SRCLK) << 16U); \
+    } else { \
+      BUS_PORT(BUS_SRCLK)->BRR = BUS_PIN(BUS_SRCLK); \
+      BUS_PORT(BUS_SER)->BSRR = SER_WORD(word, bit); \
+    } \
+    TIMING_HOLD(TIMING_HC595_T_SU); \
+    BUS_PORT(BUS_SRCLK)->BSRR = BUS_PIN(BUS_SRCLK); \
+    TIMING_HOLD(TIMING_HC595_T_W); \
+  } while (0)
+
+//* Private Typedefs
+
+typedef enum bus_port {
+  BUS_DATA_PORTS(PORT_ENUM, )
+  BUS_PORT_COUNT,
+} bus_port_t;
+
+BUS_DATA_LINES(ASSERT_PORT_LISTED, )
+
+//* Private Variables
+
+/**
+ * @brief BSRR word of every data port for every byte (1 KB of flash per port),
+ * so any byte is presented with one store per port.
+ */
+static const uint32_t bus_bsrr[256][BUS_PORT_COUNT] = {
+  BSRR_ENTRIES_64(0U), BSRR_ENTRIES_64(64U), BSRR_ENTRIES_64(128U), BSRR_ENTRIES_64(192U),
+};
+
+/**
+ * @brief Current direction of the data bus. MX_GPIO_Init() leaves the lines as
+ * inputs, without pulls and at low speed, and only MODER changes afterwards.
+ */
+static bus_direction_t direction = BUS_INPUT;
+
+//* Public Functions
+
+void bus_set_direction(bus_direction_t new_direction) {
+  if (new_direction == direction) {
+    return;
+  }
+
+  const uint8_t output = (new_direction == BUS_OUTPUT);
+  BUS_DATA_PORTS(SET_MODER, output)
+  direction = new_direction;
+}
+
+uint8_t bus_read(void) {
+  // Sample every port before assembling the byte
+  uint32_t idr[BUS_PORT_COUNT];
+  BUS_DATA_PORTS(SAMPLE_PORT, )
+
+  return (uint8_t)(0U BUS_DATA_LINES(GATHER_BIT, ));
+}
+
+uint8_t bus_read_bit(uint8_t bit) {
+  switch (bit) {
+    BUS_DATA_LINES(READ_BIT_CASE, )
+    default:
+      return 0U;
+  }
+}
+
+#if BUS_ADDRESS_BACKEND == BUS_ADDRESS_SPI
+
+void bus_init(void) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_SPI1_CLK_ENABLE();
+
+  // SRCLK and SER from SPI1_SCK and SPI1_MOSI
+  GPIO_InitStruct.Pin = ADDRESS_SCK_Pin | ADDRESS_MOSI_Pin;
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStruct.Alternate = GPIO_AF5_SPI1;
+  HAL_GPIO_Init(ADDRESS_SCK_GPIO_Port, &GPIO_InitStruct);
+
+  // Transmit-only master, 16-bit frames, LSB first, data valid on the rising
+  // edge of SCK like SRCLK, SCK at PCLK2 / 2
+  BUS_SPI->CR1 = 0U;
+  BUS_SPI->CR2 = SPI_CR2_DS;
+  BUS_SPI->CR1 = SPI_CR1_BIDIMODE | SPI_CR1_BIDIOE | SPI_CR1_SSM | SPI_CR1_SSI | SPI_CR1_LSBFIRST | SPI_CR1_MSTR;
+  BUS_SPI->CR1 |= SPI_CR1_SPE;
+}
+
+void bus_shift_address(uint16_t address) {
+  while (BUS_SPI->SR & SPI_SR_FTLVL) {
+    // Previous address still queued
+  }
+  *(__IO uint16_t*)&BUS_SPI->DR = address;
+}
+
+void bus_latch_address(void) {
+  // Wait until the frame has left the FIFO and its last SRCLK edge is out
+  while (BUS_SPI->SR & SPI_SR_FTLVL) {
+  }
+  while (BUS_SPI->SR & SPI_SR_BSY) {
+  }
+  BUS_PORT(BUS_RCLK)->BSRR = BUS_PIN(BUS_RCLK);
+  TIMING_HOLD(TIMING_HC595_T_W);
+  BUS_PORT(BUS_RCLK)->BRR = BUS_PIN(BUS_RCLK);
+}
+
+#else
+
+void bus_init(void) {
+  // MX_GPIO_Init() already set up SER and SRCLK
+}
+
+void bus_shift_address(uint16_t address) {
+  SHIFT_BIT(address, 0U);
+  SHIFT_BIT(address, 1U);
+  SHIFT_BIT(address, 2U);
+  SHIFT_BIT(address, 3U);
+  SHIFT_BIT(address, 4U);
+  SHIFT_BIT(address, 5U);
+  SHIFT_BIT(address, 6U);
+  SHIFT_BIT(address, 7U);
+  SHIFT_BIT(address, 8U);
+  SHIFT_BIT(address, 9U);
+  SHIFT_BIT(address, 10U);
+  SHIFT_BIT(address, 11U);
+  SHIFT_BIT(address, 12U);
+  SHIFT_BIT(address, 13U);
+  SHIFT_BIT(address, 14U);
+  SHIFT_BIT(address, 15U);
+  BUS_PORT(BUS_SRCLK)->BRR = BUS_PIN(BUS_SRCLK);
+}
+
+void bus_latch_address(void) {
+  TIMING_HOLD(TIMING_HC595_T_SU);
+  BUS_PORT(BUS_RCLK)->BSRR = BUS_PIN(BUS_RCLK);
+  TIMING_HOLD(TIMING_HC595_T_W);
+  BUS_PORT(BUS_RCLK)->BRR = BUS_PIN(BUS_RCLK);
+}
+
+#endif /* BUS_ADDRESS_BACKEND */
+
+void bus_write(uint8_t byte) {
+  BUS_DATA_PORTS(WRITE_PORT, bus_bsrr[byte])
+}
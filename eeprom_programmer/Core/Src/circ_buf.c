@@ -112,7 +112,7 @@ size_t circ_buf_len(const circ_buf_handle_t circ_buf) {
 
   size_t len;
   if (!circ_buf_is_full(circ_buf)) {
-    if (circ_buf->head >= circ_buf->tail) {
+    if (circ_buf->tail >= circ_buf->head) {
       len = circ_buf->tail - circ_buf->head;
     } else {
       len = circ_buf->tail + circ_buf->mem_size - circ_buf->head;
@@ -216,33 +216,33 @@ void dump_indices(const circ_buf_handle_t circ_buf) {
 void dump_hex(const uint8_t* start, size_t size, const size_t columns) {
   // Ensure arguments
   if (!(start && size && columns)) {
-    debugf("Invalid Args\n");
+    printf("Invalid Args\n");
     return;
   }
 
   size_t multirow = (columns != SIZE_MAX);
 
   if (multirow) {
-    debugf("  0000:");
+    printf("  0000:");
   }
 
   for (size_t i = 0; i < size; ++i) {
     // Jump to next row
     if (multirow) {
       if ((i > 0) && (i < size) && (i % columns == 0)) {
-        debugf("\n  %04X:", i);
+        printf("\n  %04X:", i);
       }
     }
     // Print data
     uint8_t c = start[i];
     if (c == 0) {
-      debugf("  - ");
+      printf("  - ");
     } else {
-      debugf(" x%02X", c % 0x100U);
+      printf(" x%02X", c % 0x100U);
     }
   }
 
-  debugf("\n");
+  printf("\n");
 }
 
 void dump_chars(const uint8_t* start, size_t size, const size_t columns) {
@@ -1,8 +1,96 @@
 #include "eeprom.h"
 #include "pin_manipulation.h"
+#include "strobe.h"
+#include "bus.h"
+#include "bus_pins.h"
+#include "timing.h"
 #include "circ_buf.h"
 #include "main.h"
 #include "print.h"
+#include <string.h>
+
+//* Public Variables
+
+const device_profile_t device_profiles[DEVICE_COUNT] = {
+  [DEVICE_AT28C16] = {
+    .name = "AT28C16", .address_bits = 11U, .size = 0x800U, .page_size = 1U,
+    .t_wp = 100U, .t_wc = 1000U, .t_acc = 150U,
+    .t_as = 10U, .t_oe = 70U, .t_wph = 0U, .t_blc = 0U,
+    .completion = WRITE_COMPLETION_DATA_POLLING, .sdp = 0U, .flash = 0U,
+  },
+  [DEVICE_28C64] = {
+    .name = "28C64", .address_bits = 13U, .size = 0x2000U, .page_size = 64U,
+    .t_wp = 100U, .t_wc = 10000U, .t_acc = 150U,
+    .t_as = 0U, .t_oe = 70U, .t_wph = 50U, .t_blc = 150U,
+    .completion = WRITE_COMPLETION_DATA_POLLING, .sdp = 1U, .flash = 0U,
+  },
+  [DEVICE_28C256] = {
+    .name = "28C256", .address_bits = 15U, .size = 0x8000U, .page_size = 64U,
+    .t_wp = 100U, .t_wc = 10000U, .t_acc = 150U,
+    .t_as = 0U, .t_oe = 70U, .t_wph = 50U, .t_blc = 150U,
+    .completion = WRITE_COMPLETION_DATA_POLLING, .sdp = 1U, .flash = 0U,
+  },
+  // NOR flash: tWC is the byte-program time
+  [DEVICE_SST39SF010] = {
+    .name = "SST39SF010", .address_bits = 17U, .size = 0x20000U, .page_size = 1U,
+    .t_wp = 40U, .t_wc = 20U, .t_acc = 70U,
+    .t_as = 0U, .t_oe = 35U, .t_wph = 30U, .t_blc = 0U,
+    .completion = WRITE_COMPLETION_TOGGLE_BIT, .sdp = 0U, .flash = 1U,
+    .sector_size = 0x1000U, .t_se = 25U, .t_sce = 100U, .software_id = 0xBFB5U,
+  },
+  [DEVICE_SST39SF020] = {
+    .name = "SST39SF020", .address_bits = 18U, .size = 0x40000U, .page_size = 1U,
+    .t_wp = 40U, .t_wc = 20U, .t_acc = 70U,
+    .t_as = 0U, .t_oe = 35U, .t_wph = 30U, .t_blc = 0U,
+    .completion = WRITE_COMPLETION_TOGGLE_BIT, .sdp = 0U, .flash = 1U,
+    .sector_size = 0x1000U, .t_se = 25U, .t_sce = 100U, .software_id = 0xBFB6U,
+  },
+  [DEVICE_SST39SF040] = {
+    .name = "SST39SF040", .address_bits = 19U, .size = 0x80000U, .page_size = 1U,
+    .t_wp = 40U, .t_wc = 20U, .t_acc = 70U,
+    .t_as = 0U, .t_oe = 35U, .t_wph = 30U, .t_blc = 0U,
+    .completion = WRITE_COMPLETION_TOGGLE_BIT, .sdp = 0U, .flash = 1U,
+    .sector_size = 0x1000U, .t_se = 25U, .t_sce = 100U, .software_id = 0xBFB7U,
+  },
+};
+
+//* Private Typedefs
+/**
+ * @brief A single bus write of a command sequence.
+ */
+typedef struct command_cycle {
+  uint16_t address;
+  uint8_t byte;
+} command_cycle_t;
+
+//* Private Constants
+/**
+ * @brief JEDEC SDP sequences. Addresses are masked to the device's address
+ * lines by set_address(), e.g. 5555 becomes 1555 on the 28C64.
+ */
+static const command_cycle_t sdp_unlock_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0x80U},
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0x20U},
+};
+static const command_cycle_t sdp_lock_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0xA0U},
+};
+/**
+ * @brief SST39SF command sequences. Only A14-A0 are decoded for commands.
+ */
+static const command_cycle_t flash_program_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0xA0U}, // Followed by the byte at its address
+};
+static const command_cycle_t flash_chip_erase_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0x80U},
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0x10U},
+};
+static const command_cycle_t flash_id_entry_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0x90U},
+};
+static const command_cycle_t flash_id_exit_sequence[] = {
+  {0x5555U, 0xAAU}, {0x2AAAU, 0x55U}, {0x5555U, 0xF0U},
+};
 
 //* Private EEPROM Programming Functions
 /**
@@ -15,91 +103,290 @@
  */
 uint8_t read_address(eeprom_handle_t eeprom, uint16_t address);
 /**
- * @brief Writes byte to EEPROM at given address.
+ * @brief Reads the byte at address and shifts address + 1 during tACC, so a
+ * run of sequential reads costs one RCLK pulse per address.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @return uint8_t
+ */
+static uint8_t read_sequential(eeprom_handle_t eeprom, uint16_t address);
+/**
+ * @brief Writes byte to EEPROM at given address, then waits for the write
+ * cycle to complete using the EEPROM's write completion method.
  * 
  * Output Enable MUST be disabled BEFORE pin mode is set to output so that the
  * microcontroller and EEPROM are not both set to OUTPUT at the same time.
  * @param eeprom Pointer to an EEPROM instance.
  * @param byte Byte to write to EEPROM.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+eeprom_status_t write_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte);
+/**
+ * @brief Loads a byte into the EEPROM's page buffer with a single Write Enable
+ * pulse, without waiting for a write cycle. The next address is shifted while
+ * Write Enable is low.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param byte Byte to load.
+ * @param next Address of the next load, or EEPROM_ADDRESS_NONE.
+ */
+static void load_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint32_t next);
+/**
+ * @brief Page write. Loads every byte with back-to-back Write Enable pulses so
+ * each load starts within tBLC of the previous one, then waits for the single
+ * write cycle that programs the whole page. All bytes MUST be in the same page.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param data Bytes to write, starting at address.
+ * @param current Bytes the EEPROM already holds. Equal bytes are skipped.
+ * NULL to load every byte.
+ * @param size Number of bytes, at most the EEPROM's page size.
+ * @param loaded Number of bytes actually loaded.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+static eeprom_status_t write_page(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, const uint8_t* current, uint16_t size, uint16_t* loaded);
+/**
+ * @brief Loads a byte to be programmed. NOR flash gets its byte-program
+ * command sequence first.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param byte Byte to program.
+ * @param next Address of the next load, or EEPROM_ADDRESS_NONE.
+ */
+static void load_data(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint32_t next);
+/**
+ * @brief Loads a command sequence with back-to-back Write Enable pulses, like
+ * the bytes of a page, so every cycle starts within tBLC of the previous one.
+ * The data bus MUST already be set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param sequence Bus writes, in order.
+ * @param count Number of bus writes.
+ */
+static void load_sequence(eeprom_handle_t eeprom, const command_cycle_t* sequence, size_t count);
+/**
+ * @brief Holds off every interrupt at BUS_CRITICAL_PRIORITY or below while
+ * bus cycles must follow each other within tBLC.
+ * @return The previous mask, for bus_critical_exit().
+ */
+static uint32_t bus_critical_enter(void);
+static void bus_critical_exit(uint32_t basepri);
+/**
+ * @brief Sets Output Enable LOW (Enabled) and stamps the falling edge, which
+ * tOE is measured from.
+ * @param eeprom Pointer to an EEPROM instance.
  */
-void write_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte);
+static void output_enable(eeprom_handle_t eeprom);
+/**
+ * @brief Reads I/O6 with its own Output Enable pulse, tOE long.
+ * 
+ * The data bus MUST already be set to input.
+ * @param eeprom Pointer to an EEPROM instance.
+ */
+static uint8_t read_toggle_bit(eeprom_handle_t eeprom);
+/**
+ * @brief Writes the packet to the address range. See multi_write().
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param data Bytes to write, one per address in the range.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1, `EEPROM_ERR_VERIFY`: -2
+ */
+static eeprom_status_t write_packet(eeprom_handle_t eeprom, const uint8_t* data);
+/**
+ * @brief Waits for the internal write cycle of the given byte to complete.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param byte Byte that was written.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+static eeprom_status_t wait_write_cycle(eeprom_handle_t eeprom, uint8_t byte);
+/**
+ * @brief DATA polling. While the internal write cycle is running, the EEPROM
+ * outputs the complement of bit 7 (I/O7) of the byte being written. The cycle
+ * is complete once I/O7 matches the written bit.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param timeout Time (in ms) before giving up.
+ * @param byte Byte that was written.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+static eeprom_status_t poll_data(eeprom_handle_t eeprom, uint32_t timeout, uint8_t byte);
+/**
+ * @brief Toggle bit polling. While the internal write cycle is running, I/O6
+ * toggles on every read (every falling edge of Output Enable). The cycle is
+ * complete once I/O6 stops toggling.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param timeout Time (in ms) before giving up.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1
+ */
+static eeprom_status_t poll_toggle(eeprom_handle_t eeprom, uint32_t timeout);
+/**
+ * @brief Writes a byte, then, if verify is set, reads it back and rewrites it
+ * up to the EEPROM's verify_retries times until it matches.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param verify Read back and retry the byte.
+ * @return `EEPROM_OK`: 0, `EEPROM_ERR_TIMEOUT`: -1, `EEPROM_ERR_VERIFY`: -2
+ */
+static eeprom_status_t program_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint8_t verify);
+/**
+ * @brief Verifies a written block. Every mismatched byte is rewritten, then
+ * the block is read back again, up to the EEPROM's verify_retries times.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param data Expected bytes, starting at address.
+ * @param current Scratch buffer of at least size bytes.
+ * @param failed First VERIFY_FAILURES_MAX failing addresses. New failures are
+ * appended.
+ * @param failures Number of failures already in failed.
+ * @return Total number of addresses that never verified.
+ */
+static uint16_t verify_block(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, uint8_t* current, uint16_t size, uint16_t* failed, uint16_t failures);
+/**
+ * @brief Reads size bytes starting at the given address, turning the bus
+ * around only once.
+ * 
+ * Leaves the data bus set to output with Output Enable disabled.
+ */
+static void read_range(eeprom_handle_t eeprom, uint16_t address, uint8_t* dest, uint16_t size);
+/**
+ * @brief Prints the failing addresses on a single row.
+ * @param eeprom Pointer to an EEPROM instance.
+ * @param failed First VERIFY_FAILURES_MAX failing addresses.
+ * @param failures Total number of failing addresses.
+ */
+static void print_failures(eeprom_handle_t eeprom, const uint16_t* failed, uint16_t failures);
+/**
+ * @brief Prints a run of identical bytes as RLE tokens, wrapping rows every
+ * RLE_COLUMNS tokens.
+ * @param address Address of the first byte of the run.
+ * @param byte Value of the run.
+ * @param run Length of the run. 0x10000 for a run spanning the whole window.
+ * @param column Token count of the current row. Updated by the function.
+ */
+static void print_rle_run(uint16_t address, uint8_t byte, uint32_t run, uint8_t* column);
 
 //* Public EEPROM Programming Functions
 
+void eeprom_set_device(eeprom_handle_t eeprom, device_t device) {
+  assert_param(device < DEVICE_COUNT); // Ensure profile
+
+  eeprom->device = &device_profiles[device];
+  eeprom->completion = eeprom->device->completion;
+  strobe_set_width(eeprom->device->t_wp);
+
+  eeprom->timing.t_as = timing_cycles(eeprom->device->t_as);
+  eeprom->timing.t_oe = timing_cycles(eeprom->device->t_oe);
+  eeprom->timing.t_acc = timing_cycles(eeprom->device->t_acc);
+  eeprom->timing.t_wph = timing_cycles(eeprom->device->t_wph);
+  eeprom->timing.t_blc = timing_cycles(eeprom->device->t_blc * 1000U);
+}
+
+uint32_t eeprom_size(eeprom_handle_t eeprom) {
+  if (eeprom->device->address_bits > EEPROM_BUS_ADDRESS_BITS) {
+    return (1UL << EEPROM_BUS_ADDRESS_BITS);
+  }
+  return eeprom->device->size;
+}
+
+uint8_t eeprom_address_digits(eeprom_handle_t eeprom) {
+  uint8_t bits = eeprom->device->address_bits;
+  if (bits > EEPROM_BUS_ADDRESS_BITS) {
+    bits = EEPROM_BUS_ADDRESS_BITS;
+  }
+  return (bits + 3U) / 4U;
+}
+
 void set_address(eeprom_handle_t eeprom, uint16_t address) {
-  // Mask off bits 15-11
-  address &= 0x7FFU;
+  // Mask off the bits above the device's address lines
+  address &= (uint16_t)(eeprom_size(eeprom) - 1U);
+  if (address == eeprom->latched_address) {
+    return;
+  }
 
-  // Shift address
-  shift_word(eeprom->data_port, eeprom->data_pin, eeprom->clock_port, eeprom->clock_pin, SHIFT_LSB_FIRST, address);
+  // Shift address, unless prefetch_address() already did
+  if (address != eeprom->shifted_address) {
+    bus_shift_address(address);
+    eeprom->shifted_address = address;
+  }
 
   // Latch data out from the shift register to the storage register which is tied to the output pins
-  pin_write(eeprom->latch_port, eeprom->latch_pin, GPIO_PIN_RESET);
-  pin_write(eeprom->latch_port, eeprom->latch_pin, GPIO_PIN_SET);
-  pin_write(eeprom->latch_port, eeprom->latch_pin, GPIO_PIN_RESET);
+  bus_latch_address();
+  eeprom->latched_at = timing_now();
+  eeprom->latched_address = address;
+}
+
+void prefetch_address(eeprom_handle_t eeprom, uint16_t address) {
+  address &= (uint16_t)(eeprom_size(eeprom) - 1U);
+  if (address == eeprom->shifted_address) {
+    return;
+  }
+
+  bus_shift_address(address);
+  eeprom->shifted_address = address;
 }
 
 uint8_t read_address(eeprom_handle_t eeprom, uint16_t address) {
   // Read data bus to byte
   set_address(eeprom, address);
-  uint8_t byte = 0U;
-  for (int8_t pin = 7; pin >= 0; --pin) {
-    byte = (byte << 1U) + pin_read(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin));
-  }
-
-  return byte;
+  timing_wait(eeprom->latched_at, eeprom->timing.t_acc);
+  timing_wait(eeprom->enabled_at, eeprom->timing.t_oe);
+  return bus_read();
 }
 
-void write_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte) {
-  // Write byte to data bus
+static uint8_t read_sequential(eeprom_handle_t eeprom, uint16_t address) {
   set_address(eeprom, address);
-  for (uint8_t pin = 0U; pin < 8U; pin++) { // Write data to each arduino pin using LSB mask (data & 1), then shifting out the LSB
-    // Mask the LSB
-    uint8_t bit = byte & 1U;
-    pin_write(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin), bit);
-    byte = byte >> 1;
-  }
+  prefetch_address(eeprom, address + 1U);
+  // The shift above counts towards tACC. The address may have been latched
+  // long before Output Enable fell, e.g. when reading back a written byte, so
+  // tOE is waited for as well.
+  timing_wait(eeprom->latched_at, eeprom->timing.t_acc);
+  timing_wait(eeprom->enabled_at, eeprom->timing.t_oe);
+  return bus_read();
+}
 
-  // Save the data to the EEPROM
-  neg_pulse(WRITE_ENABLE_GPIO_Port, WRITE_ENABLE_Pin);
-  HAL_Delay(5);
+eeprom_status_t write_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte) {
+  load_data(eeprom, address, byte, EEPROM_ADDRESS_NONE);
+  return wait_write_cycle(eeprom, byte);
 }
 
 void single_read(eeprom_handle_t eeprom) {
   // Set data bus pin mode to input
-  for (uint8_t pin = 0; pin < 8; ++pin) {
-    pin_mode(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin), PIN_MODE_INPUT);
-  }
+  bus_set_direction(BUS_INPUT);
   // Set Output Enable LOW (Enabled)
-  pin_write(OUTPUT_ENABLE_GPIO_Port, OUTPUT_ENABLE_Pin, GPIO_PIN_RESET);
+  output_enable(eeprom);
 
-  printf("  %03X: %02X\n", eeprom->addresses[0] % 0x1000, read_address(eeprom, eeprom->addresses[0]));
+  printf("  %0*X: %02X\n", eeprom_address_digits(eeprom), eeprom->addresses[0], read_address(eeprom, eeprom->addresses[0]));
 }
 
-void single_write(eeprom_handle_t eeprom, uint8_t byte) {
+eeprom_status_t single_write(eeprom_handle_t eeprom, uint8_t byte) {
   // Set Output Enable HIGH (Disabled)
-  pin_write(OUTPUT_ENABLE_GPIO_Port, OUTPUT_ENABLE_Pin, GPIO_PIN_SET);
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
   // Set data bus pin mode to output
-  for (uint8_t pin = 0; pin < 8; pin++) {
-    pin_mode(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin), PIN_MODE_OUTPUT);
-  }
+  bus_set_direction(BUS_OUTPUT);
 
-  write_byte(eeprom, eeprom->addresses[0], byte);
+  eeprom_status_t status = program_byte(eeprom, eeprom->addresses[0], byte, (eeprom->verify != VERIFY_OFF));
+  if (status == EEPROM_ERR_TIMEOUT) {
+    printf("  %0*X: Write Timeout\n", eeprom_address_digits(eeprom), eeprom->addresses[0]);
+  } else if (status == EEPROM_ERR_VERIFY) {
+    print_failures(eeprom, &eeprom->addresses[0], 1U);
+  }
+  return status;
 }
 
 void multi_read(eeprom_handle_t eeprom) {
   // Set data bus pin mode to input
-  for (uint8_t pin = 0; pin < 8; ++pin) {
-    pin_mode(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin), PIN_MODE_INPUT);
-  }
+  bus_set_direction(BUS_INPUT);
   // Set Output Enable LOW (Enabled)
-  pin_write(OUTPUT_ENABLE_GPIO_Port, OUTPUT_ENABLE_Pin, GPIO_PIN_RESET);
+  output_enable(eeprom);
 
   uint8_t data_packet[DATA_PACKET_SIZE] = {0};
   uint16_t address = eeprom->addresses[0];
   while (address <= eeprom->addresses[1]) {
     for (uint16_t i = 0U; i < DATA_PACKET_SIZE; ++i) {
-      data_packet[i] = read_address(eeprom, address);
+      data_packet[i] = read_sequential(eeprom, address);
       if (address == eeprom->addresses[1]) {
         dump_hex(data_packet, i + 1U, 0x20U);
         return;
@@ -110,18 +397,499 @@ void multi_read(eeprom_handle_t eeprom) {
   }
 }
 
-void multi_write(eeprom_handle_t eeprom, uint8_t* data) {
+eeprom_status_t multi_write(eeprom_handle_t eeprom, uint8_t* data) {
+  // Lift Software Data Protection for the duration of the write
+  const uint8_t sdp = eeprom->sdp_auto && eeprom->device->sdp;
+  if (sdp) {
+    sdp_unlock(eeprom);
+  }
+
+  eeprom_status_t status = write_packet(eeprom, data);
+
+  if (sdp) {
+    sdp_lock(eeprom);
+  }
+  return status;
+}
+
+void sdp_unlock(eeprom_handle_t eeprom) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  load_sequence(eeprom, sdp_unlock_sequence, sizeof(sdp_unlock_sequence) / sizeof(sdp_unlock_sequence[0]));
+  HAL_Delay((eeprom->device->t_wc + 999U) / 1000U);
+}
+
+void sdp_lock(eeprom_handle_t eeprom) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  load_sequence(eeprom, sdp_lock_sequence, sizeof(sdp_lock_sequence) / sizeof(sdp_lock_sequence[0]));
+  HAL_Delay((eeprom->device->t_wc + 999U) / 1000U);
+}
+
+eeprom_status_t flash_erase_sector(eeprom_handle_t eeprom, uint16_t address) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  // Same as the chip erase sequence, except the last cycle goes to the sector
+  command_cycle_t sequence[sizeof(flash_chip_erase_sequence) / sizeof(flash_chip_erase_sequence[0])];
+  memcpy(sequence, flash_chip_erase_sequence, sizeof(sequence));
+  sequence[5].address = address & ~(eeprom->device->sector_size - 1U);
+  sequence[5].byte = 0x30U;
+  load_sequence(eeprom, sequence, sizeof(sequence) / sizeof(sequence[0]));
+
+  return poll_toggle(eeprom, ((EEPROM_WRITE_TIMEOUT_FACTOR * eeprom->device->t_se) + 1U));
+}
+
+eeprom_status_t flash_erase_chip(eeprom_handle_t eeprom) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  load_sequence(eeprom, flash_chip_erase_sequence, sizeof(flash_chip_erase_sequence) / sizeof(flash_chip_erase_sequence[0]));
+
+  return poll_toggle(eeprom, ((EEPROM_WRITE_TIMEOUT_FACTOR * eeprom->device->t_sce) + 1U));
+}
+
+uint16_t flash_read_id(eeprom_handle_t eeprom) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  // Manufacturer ID at address 0, device ID at address 1
+  uint8_t id[2] = {0};
+  load_sequence(eeprom, flash_id_entry_sequence, sizeof(flash_id_entry_sequence) / sizeof(flash_id_entry_sequence[0]));
+  timing_delay(timing_cycles(FLASH_ID_ACCESS_TIME));
+  read_range(eeprom, 0x0000U, id, sizeof(id));
+  load_sequence(eeprom, flash_id_exit_sequence, sizeof(flash_id_exit_sequence) / sizeof(flash_id_exit_sequence[0]));
+  timing_delay(timing_cycles(FLASH_ID_ACCESS_TIME));
+
+  return (uint16_t)((id[0] << 8U) | id[1]);
+}
+
+uint8_t eeprom_load_page(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, uint16_t size) {
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  uint8_t late = 0U;
+  const uint32_t basepri = bus_critical_enter();
+  for (uint16_t i = 0U; i < size; ++i) {
+    const uint32_t next = ((i + 1U) < size) ? (uint32_t)(uint16_t)(address + i + 1U) : EEPROM_ADDRESS_NONE;
+    late = late || (i && eeprom->timing.t_blc && ((timing_now() - eeprom->strobed_at) > eeprom->timing.t_blc));
+    load_data(eeprom, address + i, data[i], next);
+  }
+  bus_critical_exit(basepri);
+
+  return late;
+}
+
+eeprom_status_t eeprom_poll_write(eeprom_handle_t eeprom, uint8_t byte) {
+  uint8_t done = 1U;
+
+  bus_set_direction(BUS_INPUT);
+  switch (eeprom->completion) {
+    case WRITE_COMPLETION_DATA_POLLING: {
+      // Two matching reads in a row, like poll_data()
+      const uint8_t bit = !!(byte & 0x80U);
+      output_enable(eeprom);
+      timing_wait(eeprom->enabled_at, eeprom->timing.t_oe);
+      done = (bus_read_bit(7U) == bit);
+      done = done && (bus_read_bit(7U) == bit);
+      pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+      break;
+    }
+
+    case WRITE_COMPLETION_TOGGLE_BIT: {
+      // Two non-toggling reads in a row, like poll_toggle()
+      const uint8_t first = read_toggle_bit(eeprom);
+      const uint8_t second = read_toggle_bit(eeprom);
+      done = (first == second) && (second == read_toggle_bit(eeprom));
+      break;
+    }
+
+    case WRITE_COMPLETION_DELAY:
+    default:
+      break;
+  }
+  bus_set_direction(BUS_OUTPUT);
+
+  return done ? EEPROM_OK : EEPROM_BUSY;
+}
+
+void multi_read_rle(eeprom_handle_t eeprom) {
+  // Set data bus pin mode to input
+  bus_set_direction(BUS_INPUT);
+  // Set Output Enable LOW (Enabled)
+  output_enable(eeprom);
+
+  uint8_t column = 0U;
+  uint16_t address = eeprom->addresses[0];
+  uint16_t run_address = address;
+  uint8_t run_byte = read_sequential(eeprom, address);
+  while (address < eeprom->addresses[1]) {
+    uint8_t byte = read_sequential(eeprom, ++address);
+    if (byte != run_byte) {
+      print_rle_run(run_address, run_byte, (uint32_t)address - run_address, &column);
+      run_address = address;
+      run_byte = byte;
+    }
+  }
+  print_rle_run(run_address, run_byte, (uint32_t)address - run_address + 1U, &column);
+
+  if (column) {
+    printf("\n");
+  }
+}
+
+//* Private Helper Functions
+
+static void load_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint32_t next) {
+  // Write byte to data bus
+  set_address(eeprom, address);
+  bus_write(byte);
+
+  // ~WE falls no earlier than tAS after the address and tWPH after the
+  // previous pulse. tAH and tDS are shorter than tWP, so the pulse covers them.
+  timing_wait(eeprom->latched_at, eeprom->timing.t_as);
+  timing_wait(eeprom->strobed_at, eeprom->timing.t_wph);
+
+  // Latch the data into the EEPROM, tWP wide. The next address only reaches
+  // the address lines at its RCLK pulse, so it can be shifted meanwhile.
+  strobe_start();
+  if (next != EEPROM_ADDRESS_NONE) {
+    prefetch_address(eeprom, (uint16_t)next);
+  }
+  strobe_wait();
+  eeprom->strobed_at = timing_now();
+}
+
+static eeprom_status_t write_page(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, const uint8_t* current, uint16_t size, uint16_t* loaded) {
+  *loaded = 0U;
+  uint16_t last = 0U;
+  uint8_t late = 0U;
+
+  // A long interrupt between two loads could outlast tBLC and start the write cycle early
+  const uint32_t basepri = bus_critical_enter();
+  for (uint16_t i = 0U; i < size; ++i) {
+    if (current && (current[i] == data[i])) {
+      continue;
+    }
+    // Next byte that is actually loaded, to shift its address ahead
+    uint16_t j = i + 1U;
+    while (current && (j < size) && (current[j] == data[j])) {
+      ++j;
+    }
+    const uint32_t next = (j < size) ? (uint32_t)(uint16_t)(address + j) : EEPROM_ADDRESS_NONE;
+    late = late || (*loaded && eeprom->timing.t_blc && ((timing_now() - eeprom->strobed_at) > eeprom->timing.t_blc));
+    load_data(eeprom, address + i, data[i], next);
+    last = i;
+    ++(*loaded);
+  }
+  bus_critical_exit(basepri);
+  if (late) {
+    LOG_WARN("tBLC exceeded %03X\n", address);
+  }
+
+  // The whole page is programmed by a single write cycle. DATA polling reads
+  // the last loaded address, which is still latched.
+  if (*loaded == 0U) {
+    return EEPROM_OK;
+  }
+  return wait_write_cycle(eeprom, data[last]);
+}
+
+static void load_data(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint32_t next) {
+  // The byte follows its command right away, and is issued as soon as the
+  // previous byte finishes programming
+  if (eeprom->device->flash) {
+    load_sequence(eeprom, flash_program_sequence, sizeof(flash_program_sequence) / sizeof(flash_program_sequence[0]));
+    // The next load starts with the first cycle of its own command
+    if (next != EEPROM_ADDRESS_NONE) {
+      next = flash_program_sequence[0].address;
+    }
+  }
+  load_byte(eeprom, address, byte, next);
+}
+
+static void load_sequence(eeprom_handle_t eeprom, const command_cycle_t* sequence, size_t count) {
+  // A long interrupt between two cycles could outlast tBLC and abort the sequence
+  const uint32_t basepri = bus_critical_enter();
+  for (size_t i = 0U; i < count; ++i) {
+    const uint32_t next = ((i + 1U) < count) ? sequence[i + 1U].address : EEPROM_ADDRESS_NONE;
+    load_byte(eeprom, sequence[i].address, sequence[i].byte, next);
+  }
+  bus_critical_exit(basepri);
+}
+
+static uint32_t bus_critical_enter(void) {
+  const uint32_t basepri = __get_BASEPRI();
+  __set_BASEPRI_MAX(BUS_CRITICAL_PRIORITY << (8U - __NVIC_PRIO_BITS));
+  return basepri;
+}
+
+static void bus_critical_exit(uint32_t basepri) {
+  __set_BASEPRI(basepri);
+}
+
+static void output_enable(eeprom_handle_t eeprom) {
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_RESET);
+  eeprom->enabled_at = timing_now();
+}
+
+static eeprom_status_t write_packet(eeprom_handle_t eeprom, const uint8_t* data) {
   // Set Output Enable HIGH (Disabled)
-  pin_write(OUTPUT_ENABLE_GPIO_Port, OUTPUT_ENABLE_Pin, GPIO_PIN_SET);
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
   // Set data bus pin mode to output
-  for (uint8_t pin = 0; pin < 8; pin++) {
-    pin_mode(DATA_BUS_PORT(pin), DATA_BUS_PIN(pin), PIN_MODE_OUTPUT);
+  bus_set_direction(BUS_OUTPUT);
+
+  // A single packet holds at most DATA_PACKET_SIZE bytes. The range is sized
+  // in 32 bits, since 0000-FFFF holds 0x10000 bytes.
+  const uint32_t range = (uint32_t)eeprom->addresses[1] - eeprom->addresses[0] + 1U;
+  const uint16_t size = (range > DATA_PACKET_SIZE) ? DATA_PACKET_SIZE : (uint16_t)range;
+
+  // Read the whole range up front so the bus is only turned around once
+  const uint8_t update = (eeprom->mode == MULTI_UPDATE_MODE);
+  uint8_t current[DATA_PACKET_SIZE] = {0};
+  if (update) {
+    read_range(eeprom, eeprom->addresses[0], current, size);
   }
 
-  const uint16_t size = eeprom->addresses[1] - eeprom->addresses[0] + 1U;
-  uint16_t address = eeprom->addresses[0];
+  // Byte-write-only parts are written as one-byte pages
+  const uint16_t page_size = (eeprom->device->page_size > 1U) ? eeprom->device->page_size : 1U;
+
+  uint16_t failed[VERIFY_FAILURES_MAX] = {0};
+  uint16_t failures = 0U;
+  uint16_t written = 0U;
+  uint16_t skipped = 0U;
+  uint16_t count = 0U;
+  for (uint16_t i = 0U; i < size; i += count) {
+    // Bytes up to the end of the page, or the end of the packet
+    const uint16_t address = eeprom->addresses[0] + i;
+    count = page_size - (address % page_size);
+    if (count > (size - i)) {
+      count = size - i;
+    }
+
+    uint16_t loaded = 0U;
+    eeprom_status_t status = write_page(eeprom, address, &data[i], (update ? &current[i] : NULL), count, &loaded);
+    if (status != EEPROM_OK) {
+      printf("  %0*X: Write Timeout\n", eeprom_address_digits(eeprom), address);
+      return status;
+    }
+    written += loaded;
+    skipped += count - loaded;
+
+    // The page's current bytes have been used, so they can hold the read back
+    if ((eeprom->verify == VERIFY_BYTE) && loaded) {
+      failures = verify_block(eeprom, address, &data[i], &current[i], count, failed, failures);
+    }
+  }
+
+  if (eeprom->verify == VERIFY_BLOCK) {
+    failures = verify_block(eeprom, eeprom->addresses[0], data, current, size, failed, 0U);
+  }
+
+  if (update) {
+    printf("  Written: %03X, Skipped: %03X\n", written, skipped);
+  }
+  if (failures) {
+    print_failures(eeprom, failed, failures);
+    return EEPROM_ERR_VERIFY;
+  }
+  return EEPROM_OK;
+}
+
+static eeprom_status_t wait_write_cycle(eeprom_handle_t eeprom, uint8_t byte) {
+  const uint32_t timeout = ((EEPROM_WRITE_TIMEOUT_FACTOR * eeprom->device->t_wc) / 1000U) + 1U;
+  switch (eeprom->completion) {
+    case WRITE_COMPLETION_DATA_POLLING:
+      return poll_data(eeprom, timeout, byte);
+      break;
+
+    case WRITE_COMPLETION_TOGGLE_BIT:
+      return poll_toggle(eeprom, timeout);
+      break;
+
+    case WRITE_COMPLETION_DELAY:
+    default:
+      HAL_Delay((eeprom->device->t_wc + 999U) / 1000U);
+      return EEPROM_OK;
+      break;
+  }
+}
+
+static eeprom_status_t poll_data(eeprom_handle_t eeprom, uint32_t timeout, uint8_t byte) {
+  eeprom_status_t status = EEPROM_OK;
+
+  // Set data bus pin mode to input, then set Output Enable LOW (Enabled)
+  bus_set_direction(BUS_INPUT);
+  output_enable(eeprom);
+  timing_wait(eeprom->enabled_at, eeprom->timing.t_oe);
+
+  // Require two matching reads in a row so the first read can't just be the
+  // charge left on the bus from the write
+  const uint8_t bit = !!(byte & 0x80U);
+  const uint32_t tick = HAL_GetTick();
+  uint8_t matches = 0U;
+  while (matches < 2U) {
+    if (bus_read_bit(7U) == bit) {
+      ++matches;
+    } else {
+      matches = 0U;
+    }
+    if ((HAL_GetTick() - tick) > timeout) {
+      LOG_ERROR("DATA polling timeout %02X\n", byte);
+      status = EEPROM_ERR_TIMEOUT;
+      break;
+    }
+  }
+
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+
+  return status;
+}
+
+static eeprom_status_t poll_toggle(eeprom_handle_t eeprom, uint32_t timeout) {
+  eeprom_status_t status = EEPROM_OK;
+
+  // Set data bus pin mode to input
+  bus_set_direction(BUS_INPUT);
+
+  // Each read is its own Output Enable pulse, since I/O6 toggles on its falling edge.
+  // Require two non-toggling reads in a row, like DATA polling.
+  const uint32_t tick = HAL_GetTick();
+  uint8_t matches = 0U;
+  uint8_t previous = 0xFFU; // Never a valid bit, so the first read can't match
+  while (matches < 2U) {
+    uint8_t bit = read_toggle_bit(eeprom);
+    if (bit == previous) {
+      ++matches;
+    } else {
+      matches = 0U;
+    }
+    previous = bit;
+    if ((HAL_GetTick() - tick) > timeout) {
+      LOG_ERROR("Toggle bit timeout\n");
+      status = EEPROM_ERR_TIMEOUT;
+      break;
+    }
+  }
+
+  // Output Enable is already HIGH (Disabled), set data bus pin mode to output
+  bus_set_direction(BUS_OUTPUT);
+
+  return status;
+}
+
+static eeprom_status_t program_byte(eeprom_handle_t eeprom, uint16_t address, uint8_t byte, uint8_t verify) {
+  eeprom_status_t status = write_byte(eeprom, address, byte);
+  if ((status != EEPROM_OK) || !verify) {
+    return status;
+  }
+
+  for (uint8_t attempt = 0U; attempt <= eeprom->verify_retries; ++attempt) {
+    uint8_t current = 0U;
+    read_range(eeprom, address, &current, 1U);
+    if (current == byte) {
+      return EEPROM_OK;
+    }
+    if (attempt < eeprom->verify_retries) {
+      LOG_WARN("Verify retry %03X\n", address);
+      status = write_byte(eeprom, address, byte);
+      if (status != EEPROM_OK) {
+        return status;
+      }
+    }
+  }
+
+  return EEPROM_ERR_VERIFY;
+}
+
+static uint16_t verify_block(eeprom_handle_t eeprom, uint16_t address, const uint8_t* data, uint8_t* current, uint16_t size, uint16_t* failed, uint16_t failures) {
+  for (uint8_t attempt = 0U; attempt <= eeprom->verify_retries; ++attempt) {
+    read_range(eeprom, address, current, size);
+
+    uint16_t mismatches = 0U;
+    for (uint16_t i = 0U; i < size; ++i) {
+      if (current[i] == data[i]) {
+        continue;
+      }
+      if (attempt < eeprom->verify_retries) {
+        // Timeouts show up as mismatches on the next pass
+        LOG_WARN("Verify retry %03X\n", address + i);
+        write_byte(eeprom, address + i, data[i]);
+      } else {
+        if (failures < VERIFY_FAILURES_MAX) {
+          failed[failures] = address + i;
+        }
+        ++failures;
+      }
+      ++mismatches;
+    }
+
+    if (mismatches == 0U) {
+      break;
+    }
+  }
+
+  return failures;
+}
+
+static void read_range(eeprom_handle_t eeprom, uint16_t address, uint8_t* dest, uint16_t size) {
+  // Set data bus pin mode to input, then set Output Enable LOW (Enabled)
+  bus_set_direction(BUS_INPUT);
+  output_enable(eeprom);
+
   for (uint16_t i = 0U; i < size; ++i) {
-    write_byte(eeprom, address, data[i]);
-    ++address;
+    dest[i] = read_sequential(eeprom, address + i);
+  }
+
+  // Set Output Enable HIGH (Disabled), then set data bus pin mode to output
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  bus_set_direction(BUS_OUTPUT);
+}
+
+static void print_failures(eeprom_handle_t eeprom, const uint16_t* failed, uint16_t failures) {
+  printf("  Verify Failed:");
+  for (uint16_t i = 0U; (i < failures) && (i < VERIFY_FAILURES_MAX); ++i) {
+    printf(" %0*X", eeprom_address_digits(eeprom), failed[i]);
+  }
+  if (failures > VERIFY_FAILURES_MAX) {
+    printf(" +%03X", failures - VERIFY_FAILURES_MAX);
+  }
+  printf("\n");
+}
+
+static uint8_t read_toggle_bit(eeprom_handle_t eeprom) {
+  output_enable(eeprom);
+  timing_wait(eeprom->enabled_at, eeprom->timing.t_oe);
+  const uint8_t bit = bus_read_bit(6U);
+  pin_write(BUS_PORT(BUS_OE), BUS_PIN(BUS_OE), GPIO_PIN_SET);
+  return bit;
+}
+
+static void print_rle_run(uint16_t address, uint8_t byte, uint32_t run, uint8_t* column) {
+  // Short runs cost less as literals, so only long runs become a single token
+  const uint32_t tokens = (run >= RLE_RUN_THRESHOLD) ? 1U : run;
+  for (uint32_t i = 0U; i < tokens; ++i) {
+    if (*column == 0U) {
+      printf("  %04X:", (unsigned int)(address + i));
+    }
+    if (run >= RLE_RUN_THRESHOLD) {
+      printf(" x%02X*%03X", byte, (unsigned int)run);
+    } else {
+      printf(" x%02X", byte);
+    }
+    if (++(*column) == RLE_COLUMNS) {
+      printf("\n");
+      *column = 0U;
+    }
   }
 }
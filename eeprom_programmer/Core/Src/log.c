@@ -0,0 +1,107 @@
+/**
+ * @brief Source C file of the tokenized logging library.
+ * @file log.c
+ */
+#include "log.h"
+#include "circ_buf.h"
+#include "main.h" // Gives assert_param
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+extern UART_HandleTypeDef huart2;
+
+/**
+ * @brief Queue of encoded records waiting for log_flush().
+ */
+static circ_buf_handle_t log_buf = NULL;
+
+//* Private Function Prototypes
+/**
+ * @brief Checks if a record byte must be escaped.
+ * @param byte Record byte.
+ * @return true if the byte is CR, LF, LOG_RECORD_SYNC or LOG_RECORD_ESC.
+ */
+static bool log_needs_escape(uint8_t byte);
+
+//* Public Functions
+
+void log_init(void) {
+  log_buf = circ_buf_init(LOG_BUF_SIZE);
+  assert_param(log_buf); // Ensure allocation successful
+}
+
+void log_write(uint8_t level, uint16_t id, uint8_t argc, ...) {
+  if (log_buf == NULL) {
+    return;
+  }
+
+  if (argc > LOG_ARGS_MAX) { // Bounds the record buffer
+    argc = LOG_ARGS_MAX;
+  }
+
+  // Header
+  uint8_t record[LOG_RECORD_SIZE_MAX] = {0};
+  size_t record_size = 0U;
+  record[record_size++] = LOG_RECORD_SYNC;
+  record[record_size++] = (uint8_t)((LOG_RECORD_HEADER_SIZE - 2U) + (argc * sizeof(uint32_t)));
+  record[record_size++] = (uint8_t)((level << 4U) | (argc & 0x0FU));
+  record[record_size++] = (uint8_t)(id & 0xFFU);
+  record[record_size++] = (uint8_t)(id >> 8U);
+
+  // Raw arguments
+  va_list args;
+  va_start(args, argc);
+  for (uint8_t i = 0U; i < argc; ++i) {
+    uint32_t arg = va_arg(args, uint32_t);
+    for (uint8_t shift = 0U; shift < 32U; shift += 8U) {
+      record[record_size++] = (uint8_t)(arg >> shift);
+    }
+  }
+  va_end(args);
+
+  // Drop the whole record if it doesn't fit once escaped
+  size_t escaped_size = record_size;
+  for (size_t i = 1U; i < record_size; ++i) {
+    if (log_needs_escape(record[i])) {
+      ++escaped_size;
+    }
+  }
+  if ((circ_buf_size(log_buf) - circ_buf_len(log_buf)) < escaped_size) {
+    return;
+  }
+
+  circ_buf_write_byte(log_buf, record[0]);
+  for (size_t i = 1U; i < record_size; ++i) {
+    if (log_needs_escape(record[i])) {
+      circ_buf_write_byte(log_buf, LOG_RECORD_ESC);
+      circ_buf_write_byte(log_buf, (uint8_t)(record[i] ^ LOG_RECORD_ESC_XOR));
+    } else {
+      circ_buf_write_byte(log_buf, record[i]);
+    }
+  }
+}
+
+void log_flush(void) {
+  if (log_buf == NULL) {
+    return;
+  }
+
+  uint8_t chunk[32] = {0};
+  size_t len = 0U;
+  while (circ_buf_read_byte(log_buf, &chunk[len]) == CIRC_BUF_OK) {
+    if (++len == sizeof(chunk)) {
+      HAL_UART_Transmit(&huart2, chunk, len, HAL_MAX_DELAY);
+      len = 0U;
+    }
+  }
+  if (len) {
+    HAL_UART_Transmit(&huart2, chunk, len, HAL_MAX_DELAY);
+  }
+}
+
+//* Private Functions
+
+static bool log_needs_escape(uint8_t byte) {
+  return (byte == '\r') || (byte == '\n') || (byte == LOG_RECORD_SYNC) || (byte == LOG_RECORD_ESC);
+}
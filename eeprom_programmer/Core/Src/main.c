@@ -22,10 +22,16 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 
+#include "autobaud.h"
 #include "circ_buf.h"
 #include "uart_rx.h"
 #include "eeprom.h"
+#include "write_engine.h"
+#include "strobe.h"
+#include "bus.h"
+#include "timing.h"
 #include "pin_manipulation.h"
+#include "log.h"
 #include "print.h" // UART printf() and debugf()
 #include <stdint.h>
 #include <string.h>
@@ -44,6 +50,8 @@ typedef enum system_state {
   SINGLE_WRITE_STATE,
   MULTI_READ_STATE,
   MULTI_WRITE_STATE,
+  ARGUMENT_STATE,
+  BAUD_CONFIRM_STATE,
 } system_state_t;
 
 /* USER CODE END PTD */
@@ -63,12 +71,13 @@ UART_HandleTypeDef huart2;
 
 /* USER CODE BEGIN PV */
 
-char printf_buffer[PRINTF_BUF_SIZE] = ""; // For print.h
-
 uart_rx_handle_t uart_rx;
 circ_buf_handle_t circ_buf;
 eeprom_handle_t eeprom;
 
+static uint32_t default_baud_rate = BAUD_RATE; // Detected at startup, reverted to if a switch isn't confirmed
+static uint32_t baud_switch_tick = 0U; // HAL tick of the last unconfirmed baud rate switch
+
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -80,6 +89,10 @@ static void MX_USART2_UART_Init(void);
 //* Private Helper Function Prototypes
 
 static void print_status(uart_rx_status_t status);
+static uint8_t argument_size(instruction_code_t instruction);
+static HAL_StatusTypeDef uart_set_baud_rate(uint32_t baud_rate);
+static uint8_t write_in_background(void);
+static void print_write_engine_result(void);
 
 /* USER CODE END PFP */
 
@@ -92,33 +105,59 @@ system_state_t startup_state_handler(system_state_t system_state) {
   // Startup Delay
   HAL_Delay(500);
 
-  // Startup Message
-  uint8_t msg[UART_PACKET_SIZE] = "========== AT28C16 PROGRAMMER ==========\n";
-  HAL_UART_Transmit(&huart2, (uint8_t*)msg, strlen((char*)msg), HAL_MAX_DELAY);
-
   // Init Circular Buffer Struct
   circ_buf = circ_buf_init(UART_PACKET_SIZE);
 
+  // Init Log Record Queue
+  log_init();
+
+  // Init Bus Timing and Address Bus Backend
+  timing_init();
+  bus_init();
+
   // Init UART Rx Struct
   char delimiter = (char)' ';
   char terminator = (char)'\n';
   uart_rx = uart_rx_init(DATA_PACKET_SIZE, delimiter, terminator);
 
   // Init EEPROM Struct
-  eeprom_t at28c16 = {
-    .data_port = SHIFT_DATA_GPIO_Port,
-    .data_pin = SHIFT_DATA_Pin,
-    .clock_port = SHIFT_CLK_GPIO_Port,
-    .clock_pin = SHIFT_CLK_Pin,
-    .latch_port = SHIFT_LATCH_GPIO_Port,
-    .latch_pin = SHIFT_LATCH_Pin,
+  static eeprom_t socket = {
     .mode = SINGLE_READ_MODE,
+    .verify = VERIFY_OFF,
+    .verify_retries = 0U,
+    .sdp_auto = 0U,
     .addresses = {0xFFF, 0xFFF},
+    .latched_address = EEPROM_ADDRESS_NONE,
+    .shifted_address = EEPROM_ADDRESS_NONE,
   };
-  eeprom = &at28c16;
+  eeprom = &socket;
+  eeprom_set_device(eeprom, DEVICE_AT28C16);
+  uart_rx_set_address_size(uart_rx, eeprom_address_digits(eeprom));
+
+  // Init Background Write Engine
+  write_engine_init(eeprom);
+
+  // Lock onto the baud rate of the host's first packet, keeping its characters
+  uint8_t first_packet[AUTOBAUD_EDGES_MAX / 2U] = {0};
+  size_t first_packet_len = sizeof(first_packet);
+  uint32_t baud_rate = autobaud_detect(AUTOBAUD_TIMEOUT, first_packet, &first_packet_len);
+  default_baud_rate = baud_rate ? baud_rate : BAUD_RATE;
+
+  // UART Interrupt RX Setup, at BAUD_RATE if the detected rate can't be set
+  if (uart_set_baud_rate(default_baud_rate) != HAL_OK) {
+    LOG_WARN("Baud rate %u rejected\n", baud_rate);
+  }
+  for (size_t i = 0U; i < first_packet_len; ++i) {
+    circ_buf_write_ov_byte(circ_buf, first_packet[i]);
+  }
 
-  // UART Interrupt RX Setup
-  HAL_UART_Receive_IT(&huart2, uart_rx_char(uart_rx), 1U);
+  // Write Enable Strobe Setup, TIM2 is free once autobaud is done
+  strobe_init(eeprom->device->t_wp);
+
+  // Startup Message
+  printf("========== EEPROM PROGRAMMER ==========\n");
+  printf("--- %u Baud ---\n", (unsigned int)default_baud_rate);
+  printf("--- Device %s ---\n", eeprom->device->name);
 
   // Startup Delay
   HAL_Delay(500);
@@ -160,6 +199,103 @@ system_state_t instruction_state_handler(system_state_t system_state) {
         return ADDRESS_STATE;
         break;
 
+      case MULTI_UPDATE_INSTRUCTION:
+        printf("--- Multi-Byte Update ---\n");
+        printf("Enter Addresses:\n");
+        eeprom->mode = MULTI_UPDATE_MODE;
+        return ADDRESS_STATE;
+        break;
+
+      case MULTI_READ_RLE_INSTRUCTION:
+        printf("--- Compressed Multi-Byte Read ---\n");
+        printf("Enter Addresses:\n");
+        eeprom->mode = MULTI_READ_RLE_MODE;
+        return ADDRESS_STATE;
+        break;
+
+      case SET_BAUD_INSTRUCTION:
+        printf("--- Set Baud Rate ---\n");
+        printf("Enter Baud Rate:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case WRITE_COMPLETION_INSTRUCTION:
+        printf("--- Set Write Completion Method ---\n");
+        printf("Enter Method:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case VERIFY_INSTRUCTION:
+        printf("--- Set Write Verify ---\n");
+        printf("Enter Mode and Retries:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case DEVICE_INSTRUCTION:
+        printf("--- Select Device ---\n");
+        for (uint8_t i = 0U; i < DEVICE_COUNT; ++i) {
+          printf("  %02X: %s\n", i, device_profiles[i].name);
+        }
+        printf("Enter Device:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case SDP_INSTRUCTION:
+        printf("--- Software Data Protection ---\n");
+        printf("Enter Action:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case SECTOR_ERASE_INSTRUCTION:
+        if (!eeprom->device->flash) {
+          new_status = UART_RX_INVALID_INSTRUCTION;
+          print_status(new_status);
+          break;
+        }
+        printf("--- Sector Erase ---\n");
+        printf("Enter Address:\n");
+        return ARGUMENT_STATE;
+        break;
+
+      case CHIP_ERASE_INSTRUCTION:
+        if (!eeprom->device->flash) {
+          new_status = UART_RX_INVALID_INSTRUCTION;
+          print_status(new_status);
+          break;
+        }
+        printf("--- Chip Erase ---\n");
+        write_engine_flush();
+        if (flash_erase_chip(eeprom) == EEPROM_OK) {
+          printf("--- Erase Complete ---\n");
+        } else {
+          printf("--- Erase Failed ---\n");
+        }
+        printf("Enter Instruction:\n");
+        return INSTRUCTION_STATE;
+        break;
+
+      case SOFTWARE_ID_INSTRUCTION:
+        if (!eeprom->device->flash) {
+          new_status = UART_RX_INVALID_INSTRUCTION;
+          print_status(new_status);
+          break;
+        }
+        printf("--- Software ID ---\n");
+        write_engine_flush();
+        {
+          const uint16_t id = flash_read_id(eeprom);
+          printf("  Manufacturer: %02X, Device: %02X\n", id >> 8U, id & 0xFFU);
+          for (uint8_t i = 0U; i < DEVICE_COUNT; ++i) {
+            if (device_profiles[i].software_id == id) {
+              printf("  %s\n", device_profiles[i].name);
+            }
+          }
+        }
+        printf("--- Read Complete ---\n");
+        printf("Enter Instruction:\n");
+        return INSTRUCTION_STATE;
+        break;
+
       default:
         new_status = UART_RX_INVALID_INSTRUCTION;
         print_status(new_status);
@@ -177,24 +313,26 @@ system_state_t address_state_handler(system_state_t system_state) {
   static uart_rx_status_t status = UART_RX_EMPTY;
   uart_rx_status_t new_status = uart_rx_parse_address(uart_rx, circ_buf, eeprom, status);
   if (new_status == UART_RX_VALID_PACKET) {
-    if ((eeprom->addresses[0] <= EEPROM_ADDRESS_MAX) && (eeprom->addresses[1] <= EEPROM_ADDRESS_MAX)) {
+    if ((eeprom->addresses[0] < eeprom_size(eeprom)) && (eeprom->addresses[1] < eeprom_size(eeprom))) {
       switch (eeprom->mode) {
         case SINGLE_READ_MODE:
           return SINGLE_READ_STATE;
           break;
 
         case SINGLE_WRITE_MODE:
-          printf("--- Writing Address %03X ---\n", eeprom->addresses[0] % 0x1000);
+          printf("--- Writing Address %0*X ---\n", eeprom_address_digits(eeprom), eeprom->addresses[0]);
           printf("Enter Data:\n");
           return DATA_STATE;
           break;
 
         case MULTI_READ_MODE:
+        case MULTI_READ_RLE_MODE:
           return MULTI_READ_STATE;
           break;
 
         case MULTI_WRITE_MODE:
-          printf("--- Writing Addresses %03X:%03X ---\n", eeprom->addresses[0] % 0x1000, eeprom->addresses[1] % 0x1000);
+        case MULTI_UPDATE_MODE:
+          printf("--- Writing Addresses %0*X:%0*X ---\n", eeprom_address_digits(eeprom), eeprom->addresses[0], eeprom_address_digits(eeprom), eeprom->addresses[1]);
           printf("Enter Data:\n");
           return DATA_STATE;
           break;
@@ -220,13 +358,16 @@ system_state_t data_state_handler(system_state_t system_state) {
   static uart_rx_status_t status = UART_RX_EMPTY;
   uart_rx_status_t new_status = uart_rx_parse_data(uart_rx, circ_buf, status);
   if (new_status == UART_RX_VALID_PACKET) {
-    dump_hex(uart_rx_packet(uart_rx), uart_rx_size(uart_rx), 0x20); /* UNIT_TEST */
+#ifdef UNIT_TEST
+    dump_hex(uart_rx_packet(uart_rx), uart_rx_size(uart_rx), 0x20);
+#endif /* UNIT_TEST */
     switch (eeprom->mode) {
       case SINGLE_WRITE_MODE:
         return SINGLE_WRITE_STATE;
         break;
 
       case MULTI_WRITE_MODE:
+      case MULTI_UPDATE_MODE:
         return MULTI_WRITE_STATE;
         break;
 
@@ -244,8 +385,9 @@ system_state_t data_state_handler(system_state_t system_state) {
 }
 
 system_state_t single_read_state_handler(system_state_t system_state) {
-  printf("--- Reading Address %03X ---\n", eeprom->addresses[0] % 0x1000);
+  printf("--- Reading Address %0*X ---\n", eeprom_address_digits(eeprom), eeprom->addresses[0]);
 
+  write_engine_flush();
   single_read(eeprom);
 
   printf("--- Read Complete ---\n");
@@ -256,9 +398,12 @@ system_state_t single_read_state_handler(system_state_t system_state) {
 system_state_t single_write_state_handler(system_state_t system_state) {
   printf("--- Writing Data ---\n");
 
-  single_write(eeprom, *uart_rx_packet(uart_rx));
-
-  printf("--- Write Complete ---\n");
+  write_engine_flush();
+  if (single_write(eeprom, *uart_rx_packet(uart_rx)) == EEPROM_OK) {
+    printf("--- Write Complete ---\n");
+  } else {
+    printf("--- Write Failed ---\n");
+  }
   printf("Enter Instruction:\n");
   return INSTRUCTION_STATE;
 }
@@ -269,9 +414,14 @@ system_state_t multi_read_state_handler(system_state_t system_state) {
     print_status(UART_RX_INVALID_RANGE);
     return ADDRESS_STATE;
   }
-  printf("--- Reading Addresses %03X:%03X ---\n", eeprom->addresses[0] % 0x1000, eeprom->addresses[1] % 0x1000);
+  printf("--- Reading Addresses %0*X:%0*X ---\n", eeprom_address_digits(eeprom), eeprom->addresses[0], eeprom_address_digits(eeprom), eeprom->addresses[1]);
 
-  multi_read(eeprom);
+  write_engine_flush();
+  if (eeprom->mode == MULTI_READ_RLE_MODE) {
+    multi_read_rle(eeprom);
+  } else {
+    multi_read(eeprom);
+  }
 
   printf("--- Read Complete ---\n");
   printf("Enter Instruction:\n");
@@ -286,13 +436,166 @@ system_state_t multi_write_state_handler(system_state_t system_state) {
   }
   printf("--- Writing Data ---\n");
 
-  multi_write(eeprom, uart_rx_packet(uart_rx));
+  // Program in the background while the host sends the next packet
+  if (write_in_background()) {
+    const uint32_t range = (uint32_t)eeprom->addresses[1] - eeprom->addresses[0] + 1U;
+    const uint16_t size = (range > DATA_PACKET_SIZE) ? DATA_PACKET_SIZE : (uint16_t)range;
+    while (write_engine_enqueue(eeprom->addresses[0], uart_rx_packet(uart_rx), size) != WRITE_ENGINE_OK) {
+      __WFI();
+    }
+    printf("--- Write Queued ---\n");
+    printf("Enter Instruction:\n");
+    return INSTRUCTION_STATE;
+  }
 
-  printf("--- Write Complete ---\n");
+  write_engine_flush();
+  if (multi_write(eeprom, uart_rx_packet(uart_rx)) == EEPROM_OK) {
+    printf("--- Write Complete ---\n");
+  } else {
+    printf("--- Write Failed ---\n");
+  }
   printf("Enter Instruction:\n");
   return INSTRUCTION_STATE;
 }
 
+system_state_t argument_state_handler(system_state_t system_state) {
+  static uart_rx_status_t status = UART_RX_EMPTY;
+  const instruction_code_t instruction = uart_rx_instruction(uart_rx);
+  size_t argument = 0U;
+  uart_rx_status_t new_status = uart_rx_parse_argument(uart_rx, circ_buf, &argument, argument_size(instruction));
+  if (new_status == UART_RX_VALID_PACKET) {
+    // Settings apply to the next write, and erase commands need the bus
+    write_engine_flush();
+    switch (instruction) {
+      case SET_BAUD_INSTRUCTION:
+        if ((argument >= BAUD_RATE_MIN) && (argument <= (HAL_RCC_GetPCLK1Freq() / 8U))) {
+          printf("--- Switching to %u Baud ---\n", (unsigned int)argument);
+          printf("Confirm Baud Rate:\n");
+          print_flush(); // Must go out at the old baud rate
+          if (uart_set_baud_rate(argument) != HAL_OK) {
+            printf("--- Baud Rate Reverted to %u ---\n", (unsigned int)default_baud_rate);
+            printf("Enter Instruction:\n");
+            return INSTRUCTION_STATE;
+          }
+          baud_switch_tick = HAL_GetTick();
+          return BAUD_CONFIRM_STATE;
+        }
+        new_status = UART_RX_INVALID_DATA;
+        print_status(new_status);
+        break;
+
+      case WRITE_COMPLETION_INSTRUCTION:
+        if (argument < WRITE_COMPLETION_COUNT) {
+          eeprom->completion = (write_completion_t)argument;
+          printf("--- Write Completion Method %02X ---\n", (unsigned int)argument);
+          printf("Enter Instruction:\n");
+          return INSTRUCTION_STATE;
+        }
+        new_status = UART_RX_INVALID_DATA;
+        print_status(new_status);
+        break;
+
+      case VERIFY_INSTRUCTION:
+        if ((argument >> 8U) < VERIFY_MODE_COUNT) {
+          eeprom->verify = (verify_mode_t)(argument >> 8U);
+          eeprom->verify_retries = (uint8_t)argument;
+          printf("--- Verify Mode %02X, %02X Retries ---\n", eeprom->verify, eeprom->verify_retries);
+          printf("Enter Instruction:\n");
+          return INSTRUCTION_STATE;
+        }
+        new_status = UART_RX_INVALID_DATA;
+        print_status(new_status);
+        break;
+
+      case DEVICE_INSTRUCTION:
+        if (argument < DEVICE_COUNT) {
+          eeprom_set_device(eeprom, (device_t)argument);
+          uart_rx_set_address_size(uart_rx, eeprom_address_digits(eeprom));
+          printf("--- Device %s, %X Bytes ---\n", eeprom->device->name, (unsigned int)eeprom_size(eeprom));
+          printf("Enter Instruction:\n");
+          return INSTRUCTION_STATE;
+        }
+        new_status = UART_RX_INVALID_DATA;
+        print_status(new_status);
+        break;
+
+      case SDP_INSTRUCTION:
+        if ((argument < SDP_ACTION_COUNT) && eeprom->device->sdp) {
+          switch ((sdp_action_t)argument) {
+            case SDP_UNLOCK:
+              sdp_unlock(eeprom);
+              printf("--- SDP Unlocked ---\n");
+              break;
+            case SDP_LOCK:
+              sdp_lock(eeprom);
+              printf("--- SDP Locked ---\n");
+              break;
+            case SDP_AUTO_OFF:
+            case SDP_AUTO_ON:
+              eeprom->sdp_auto = (argument == SDP_AUTO_ON);
+              printf("--- SDP Auto %s ---\n", eeprom->sdp_auto ? "On" : "Off");
+              break;
+            default:
+              break;
+          }
+          printf("Enter Instruction:\n");
+          return INSTRUCTION_STATE;
+        }
+        new_status = UART_RX_INVALID_DATA;
+        print_status(new_status);
+        break;
+
+      case SECTOR_ERASE_INSTRUCTION:
+        if (argument < eeprom_size(eeprom)) {
+          printf("--- Erasing Sector %0*X ---\n", eeprom_address_digits(eeprom), (unsigned int)(argument & ~(eeprom->device->sector_size - 1U)));
+          if (flash_erase_sector(eeprom, (uint16_t)argument) == EEPROM_OK) {
+            printf("--- Erase Complete ---\n");
+          } else {
+            printf("--- Erase Failed ---\n");
+          }
+          printf("Enter Instruction:\n");
+          return INSTRUCTION_STATE;
+        }
+        new_status = UART_RX_INVALID_ADDRESS;
+        print_status(new_status);
+        break;
+
+      default:
+        printf("Enter Instruction:\n");
+        return INSTRUCTION_STATE;
+        break;
+    }
+  } else if ((new_status != UART_RX_EMPTY) && (new_status != status)) {
+    print_status(new_status);
+  }
+  status = new_status;
+  HAL_Delay(1000 / PACKET_POLLING_RATE);
+  return ARGUMENT_STATE;
+}
+
+system_state_t baud_confirm_state_handler(system_state_t system_state) {
+  // Anything received before the host switched over is garbage and gets dropped
+  if ((uart_rx_parse_instruction(uart_rx, circ_buf) == UART_RX_VALID_PACKET) &&
+  (uart_rx_instruction(uart_rx) == BAUD_CONFIRM_INSTRUCTION)) {
+    printf("--- Baud Rate Confirmed ---\n");
+    printf("Enter Instruction:\n");
+    return INSTRUCTION_STATE;
+  }
+
+  // Fall back to a baud rate the host can always open with
+  if ((HAL_GetTick() - baud_switch_tick) > BAUD_CONFIRM_TIMEOUT) {
+    if (uart_set_baud_rate(default_baud_rate) != HAL_OK) {
+      LOG_WARN("Default baud rate rejected\n");
+    }
+    printf("--- Baud Rate Reverted to %u ---\n", (unsigned int)default_baud_rate);
+    printf("Enter Instruction:\n");
+    return INSTRUCTION_STATE;
+  }
+
+  HAL_Delay(1000 / PACKET_POLLING_RATE);
+  return BAUD_CONFIRM_STATE;
+}
+
 //* Private Helper Functions
 
 static void print_status(uart_rx_status_t status) {
@@ -326,6 +629,69 @@ static void print_status(uart_rx_status_t status) {
   printf("%02d: %s\n", (int)status, (uint8_t*)status_msg);
 }
 
+static uint8_t argument_size(instruction_code_t instruction) {
+  switch (instruction) {
+    case SET_BAUD_INSTRUCTION:
+      return BAUD_RATE_CODED_SIZE;
+    case WRITE_COMPLETION_INSTRUCTION:
+      return ACH_SIZE;
+    case VERIFY_INSTRUCTION:
+      return VERIFY_CODED_SIZE;
+    case DEVICE_INSTRUCTION:
+      return DEVICE_CODED_SIZE;
+    case SDP_INSTRUCTION:
+      return SDP_CODED_SIZE;
+    case SECTOR_ERASE_INSTRUCTION:
+      return eeprom_address_digits(eeprom);
+    default:
+      return 0U;
+  }
+}
+
+static HAL_StatusTypeDef uart_set_baud_rate(uint32_t baud_rate) {
+  HAL_UART_AbortReceive(&huart2);
+
+  // 8x oversampling doubles the maximum baud rate to PCLK1 / 8
+  huart2.Init.BaudRate = baud_rate;
+  huart2.Init.OverSampling = (baud_rate > (HAL_RCC_GetPCLK1Freq() / 16U)) ? UART_OVERSAMPLING_8 : UART_OVERSAMPLING_16;
+  HAL_StatusTypeDef status = HAL_UART_Init(&huart2);
+  if (status != HAL_OK) {
+    // Never leave the port dead: go back to the default baud rate, or to
+    // BAUD_RATE if the default itself was rejected
+    const uint32_t fallback = (baud_rate != default_baud_rate) ? default_baud_rate : BAUD_RATE;
+    if (baud_rate == fallback) {
+      Error_Handler();
+    }
+    default_baud_rate = fallback;
+    uart_set_baud_rate(fallback);
+    return status;
+  }
+
+  // Drop anything received at the old baud rate, then reactivate UART Interrupt RX
+  circ_buf_clear(circ_buf);
+  HAL_UART_Receive_IT(&huart2, uart_rx_char(uart_rx), 1U);
+
+  return status;
+}
+
+static uint8_t write_in_background(void) {
+  // Update mode, verify and SDP wrapping need the bus in between writes, so
+  // they run in the foreground
+  return (eeprom->mode == MULTI_WRITE_MODE) && (eeprom->verify == VERIFY_OFF) &&
+  !(eeprom->sdp_auto && eeprom->device->sdp);
+}
+
+static void print_write_engine_result(void) {
+  uint16_t address = 0U;
+  if (write_engine_late(&address)) {
+    printf("  %0*X: tBLC Exceeded\n", eeprom_address_digits(eeprom), address);
+  }
+  if (write_engine_result(&address) != EEPROM_OK) {
+    printf("  %0*X: Write Timeout\n", eeprom_address_digits(eeprom), address);
+    printf("--- Write Failed ---\n");
+  }
+}
+
 /* USER CODE END 0 */
 
 /**
@@ -399,11 +765,22 @@ int main(void)
       case MULTI_WRITE_STATE:
         system_state = multi_write_state_handler(system_state);
         break;
+      case ARGUMENT_STATE:
+        system_state = argument_state_handler(system_state);
+        break;
+      case BAUD_CONFIRM_STATE:
+        system_state = baud_confirm_state_handler(system_state);
+        break;
 
       default:
         system_state = startup_state_handler(system_state);
         break;
     }
+
+    // Send the state handler's response as one frame, then any log records
+    print_write_engine_result();
+    print_flush();
+    log_flush();
   }
 
   /* USER CODE END 3 */
@@ -0,0 +1,65 @@
+/**
+ * @brief Source C file of the UART response builder.
+ * @file print.c
+ */
+#include "print.h"
+#include "main.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * @brief Response frame. Holds the output of the current command until
+ * print_flush().
+ */
+static char printf_buffer[PRINTF_BUF_SIZE] = "";
+static size_t printf_len = 0U;
+
+//* Private Function Prototypes
+
+static uint32_t print_timeout(size_t len);
+
+//* Public Functions
+
+void print_append(const char* format, ...) {
+  va_list args;
+  for (uint8_t attempt = 0U; attempt < 2U; ++attempt) {
+    const size_t space = PRINTF_BUF_SIZE - printf_len;
+    va_start(args, format);
+    int len = vsnprintf(&printf_buffer[printf_len], space, format, args);
+    va_end(args);
+    if (len < 0) {
+      return;
+    }
+    if ((size_t)len < space) {
+      printf_len += len;
+      return;
+    }
+    if (printf_len == 0U) {
+      // Longer than a whole frame, send the truncated text vsnprintf() left
+      printf_len = PRINTF_BUF_SIZE - 1U;
+      print_flush();
+      return;
+    }
+    // Didn't fit, drop the partial text and retry in an empty frame
+    printf_buffer[printf_len] = '\0';
+    print_flush();
+  }
+}
+
+void print_flush(void) {
+  if (printf_len == 0U) {
+    return;
+  }
+
+  HAL_UART_Transmit(&huart2, (uint8_t*)printf_buffer, (uint16_t)printf_len, print_timeout(printf_len));
+  printf_len = 0U;
+  printf_buffer[0] = '\0';
+}
+
+//* Private Helper Functions
+
+static uint32_t print_timeout(size_t len) {
+  // 10 bits per byte (start + 8 data + stop)
+  return PRINTF_TIMEOUT + (uint32_t)((len * 10U * 1000U) / huart2.Init.BaudRate);
+}
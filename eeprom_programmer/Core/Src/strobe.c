@@ -0,0 +1,68 @@
+/**
+ * @brief Source C file of the Write Enable strobe.
+ * @file strobe.c
+ */
+#include "strobe.h"
+#include "bus_pins.h"
+#include "main.h"
+#include <stdint.h>
+
+//* Private Function Prototypes
+
+static uint32_t timer_clock(void);
+
+//* Public Functions
+
+void strobe_init(uint32_t width) {
+  GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+  __HAL_RCC_TIM2_CLK_ENABLE();
+
+  // PWM mode 2 with an inverted output: high while CNT < CCR2, low from CCR2 to
+  // ARR. One-pulse mode stops the counter at the update event, back at CNT = 0.
+  TIM2->CR1 = TIM_CR1_OPM;
+  TIM2->PSC = 0U;
+  TIM2->CCR2 = 1U;
+  TIM2->CCMR1 = TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_0;
+  TIM2->CCER = TIM_CCER_CC2P | TIM_CCER_CC2E;
+  strobe_set_width(width);
+  TIM2->EGR = TIM_EGR_UG;
+  TIM2->SR = 0U;
+
+  // Hand ~WE over to TIM2_CH2, which now idles high
+  GPIO_InitStruct.Pin = BUS_PIN(BUS_WE);
+  GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+  GPIO_InitStruct.Pull = GPIO_NOPULL;
+  GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+  GPIO_InitStruct.Alternate = GPIO_AF1_TIM2;
+  HAL_GPIO_Init(BUS_PORT(BUS_WE), &GPIO_InitStruct);
+}
+
+void strobe_set_width(uint32_t width) {
+  // Round up, so the pulse is never shorter than the device's tWP
+  uint32_t ticks = ((width * (timer_clock() / 1000000U)) + 999U) / 1000U;
+  if (ticks == 0U) {
+    ticks = 1U;
+  }
+
+  // The pulse runs from CCR2 = 1 to ARR
+  TIM2->ARR = ticks;
+}
+
+void strobe_start(void) {
+  TIM2->CR1 |= TIM_CR1_CEN;
+}
+
+void strobe_wait(void) {
+  while (TIM2->CR1 & TIM_CR1_CEN) {
+    // One-pulse mode clears CEN when the pulse ends
+  }
+}
+
+//* Private Helper Functions
+
+static uint32_t timer_clock(void) {
+  // APB1 timers run at twice PCLK1 whenever APB1 is divided
+  const uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+  return (RCC->CFGR & RCC_CFGR_PPRE1_2) ? (2U * pclk1) : pclk1;
+}
@@ -0,0 +1,22 @@
+/**
+ * @brief Source C file of the DWT bus timing.
+ * @file timing.c
+ */
+#include "timing.h"
+#include "main.h"
+#include <stdint.h>
+
+//* Public Functions
+
+void timing_init(void) {
+  assert_param(SystemCoreClock <= TIMING_CORE_CLOCK_HZ); // Compile-time waits would be short
+
+  // The DWT is only clocked while trace is enabled
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0U;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t timing_cycles(uint32_t ns) {
+  return (uint32_t)((((uint64_t)ns * SystemCoreClock) + 999999999ULL) / 1000000000ULL);
+}
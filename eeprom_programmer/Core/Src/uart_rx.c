@@ -12,7 +12,7 @@ struct uart_rx {
   instruction_code_t instruction;
   size_t packet_size;
   uint8_t coded_byte_size; // Size of 1 byte represented in ASCII-Coded hex
-  uint8_t coded_address_size; // Chars required to represent EEPROM_ADDRESS_MAX in ASCII-Coded hex
+  uint8_t coded_address_size; // Chars required to represent the highest address in ASCII-Coded hex
   char delimiter;
   char terminator;
 };
@@ -68,16 +68,19 @@ uart_rx_status_t uart_rx_parse_instruction(const uart_rx_handle_t uart_rx, const
 }
 
 uart_rx_status_t uart_rx_parse_address(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, eeprom_handle_t eeprom, uart_rx_status_t status) {
+  size_t address = 0U; // Parsed at full width, then narrowed to the address field
   if (eeprom->mode == SINGLE_READ_MODE || eeprom->mode == SINGLE_WRITE_MODE) {
-    status = uart_rx_strtohex(uart_rx, circ_buf, (size_t*)&eeprom->addresses[0], uart_rx->coded_address_size);
+    status = uart_rx_strtohex(uart_rx, circ_buf, &address, uart_rx->coded_address_size);
     if (status == UART_RX_VALID_DATA) {
       status = UART_RX_INVALID_FORMAT;
+    } else if (status == UART_RX_VALID_PACKET) {
+      eeprom->addresses[0] = (uint16_t)address;
     }
     circ_buf_clear(circ_buf);
     return status;
   } else {
     // Start Address
-    status = uart_rx_strtohex(uart_rx, circ_buf, (size_t*)&eeprom->addresses[0], uart_rx->coded_address_size);
+    status = uart_rx_strtohex(uart_rx, circ_buf, &address, uart_rx->coded_address_size);
     if (status != UART_RX_VALID_DATA) {
       if (status == UART_RX_VALID_PACKET) {
         status = UART_RX_INVALID_FORMAT;
@@ -85,8 +88,9 @@ uart_rx_status_t uart_rx_parse_address(const uart_rx_handle_t uart_rx, const cir
       circ_buf_clear(circ_buf);
       return status;
     }
+    eeprom->addresses[0] = (uint16_t)address;
     // End Address
-    status = uart_rx_strtohex(uart_rx, circ_buf, (size_t*)&eeprom->addresses[1], uart_rx->coded_address_size);
+    status = uart_rx_strtohex(uart_rx, circ_buf, &address, uart_rx->coded_address_size);
     if (status != UART_RX_VALID_PACKET) {
       if (status == UART_RX_VALID_DATA) {
         status = UART_RX_INVALID_FORMAT;
@@ -94,14 +98,19 @@ uart_rx_status_t uart_rx_parse_address(const uart_rx_handle_t uart_rx, const cir
       circ_buf_clear(circ_buf);
       return status;
     }
+    eeprom->addresses[1] = (uint16_t)address;
   }
 
   return status;
 }
 
 uart_rx_status_t uart_rx_parse_data(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, uart_rx_status_t status) {
+  size_t byte = 0U; // Parsed at full width, then narrowed to the packet byte
   for (size_t i = 0U; i < uart_rx->packet_size; ++i) {
-    status = uart_rx_strtohex(uart_rx, circ_buf, (size_t*)&(uart_rx->packet[i]), uart_rx->coded_byte_size);
+    status = uart_rx_strtohex(uart_rx, circ_buf, &byte, uart_rx->coded_byte_size);
+    if ((status == UART_RX_VALID_DATA) || (status == UART_RX_VALID_PACKET)) {
+      uart_rx->packet[i] = (uint8_t)byte;
+    }
     if (status != UART_RX_VALID_DATA) {
       circ_buf_clear(circ_buf);
       return status;
@@ -111,6 +120,17 @@ uart_rx_status_t uart_rx_parse_data(const uart_rx_handle_t uart_rx, const circ_b
   return status;
 }
 
+uart_rx_status_t uart_rx_parse_argument(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, size_t* argument, uint8_t coded_size) {
+  assert_param(argument); // Ensure destination
+
+  uart_rx_status_t status = uart_rx_strtohex(uart_rx, circ_buf, argument, coded_size);
+  if (status == UART_RX_VALID_DATA) {
+    status = UART_RX_INVALID_FORMAT; // Only a single argument is allowed
+  }
+  circ_buf_clear(circ_buf);
+  return status;
+}
+
 uart_rx_status_t uart_rx_strtohex(const uart_rx_handle_t uart_rx, const circ_buf_handle_t circ_buf, size_t* dest, uint8_t coded_size) {
   uart_rx_status_t status = UART_RX_INVALID_DATA; // Assume failure
 
@@ -126,6 +146,7 @@ uart_rx_status_t uart_rx_strtohex(const uart_rx_handle_t uart_rx, const circ_buf
   // Convert characters to hex
   ssize_t data = strtohex(byte);
   if (data < 0) {
+    free(byte);
     return UART_RX_INVALID_DATA;
   } else {
     data = data; // Convert to unsigned
@@ -143,6 +164,7 @@ uart_rx_status_t uart_rx_strtohex(const uart_rx_handle_t uart_rx, const circ_buf
     // Both data and packet are valid if terminator character follows the byte
     status = UART_RX_VALID_PACKET;
   } else {
+    free(byte);
     return UART_RX_INVALID_FORMAT;
   }
 
@@ -152,6 +174,12 @@ uart_rx_status_t uart_rx_strtohex(const uart_rx_handle_t uart_rx, const circ_buf
   return status;
 }
 
+void uart_rx_set_address_size(const uart_rx_handle_t uart_rx, uint8_t coded_size) {
+  assert_param(uart_rx && coded_size); // Ensure arguments
+
+  uart_rx->coded_address_size = coded_size;
+}
+
 void uart_rx_clear(const uart_rx_handle_t uart_rx) {
   memset(uart_rx->packet, 0U, uart_rx->packet_size);
 }
@@ -0,0 +1,228 @@
+/**
+ * @brief Source C file of the background write engine.
+ * @file write_engine.c
+ */
+#include "write_engine.h"
+#include "eeprom.h"
+#include "timing.h"
+#include "main.h"
+#include <stdint.h>
+#include <string.h>
+
+//* Private Typedefs
+
+typedef struct write_job {
+  uint16_t address;
+  uint16_t size;
+  uint8_t data[DATA_PACKET_SIZE];
+} write_job_t;
+
+typedef enum engine_state {
+  ENGINE_LOAD, // Load the next page of the current job
+  ENGINE_POLL, // Wait for the write cycle of the loaded page
+} engine_state_t;
+
+//* Private Variables
+
+static eeprom_handle_t engine_eeprom = NULL;
+/**
+ * @brief Single-producer (main loop), single-consumer (TIM6 interrupt) queue.
+ * Indices only ever increase, the slot is the index modulo the queue size.
+ */
+static write_job_t jobs[WRITE_ENGINE_QUEUE_SIZE];
+static volatile uint32_t jobs_head = 0U; // Written by the main loop only
+static volatile uint32_t jobs_tail = 0U; // Written by the interrupt only
+
+static engine_state_t state = ENGINE_LOAD;
+static uint16_t offset = 0U; // Next byte of the current job
+static uint16_t loaded = 0U; // Bytes in the page being programmed
+static uint16_t page_loaded = 0U; // Bytes of the page loaded so far
+static uint32_t loaded_at = 0U; // timing_now() once the whole page is loaded
+static uint32_t write_time = 0U; // tWC, in DWT cycles
+static uint32_t write_timeout = 0U; // DWT cycles
+
+static volatile eeprom_status_t result = EEPROM_OK;
+static volatile uint16_t result_address = 0U;
+static volatile uint8_t late = 0U;
+static volatile uint16_t late_address = 0U;
+
+//* Private Function Prototypes
+
+static void timer_start(void);
+static void timer_stop(void);
+static uint32_t timer_clock(void);
+static void job_done(void);
+
+//* Public Functions
+
+void write_engine_init(eeprom_handle_t eeprom) {
+  assert_param(eeprom); // Ensure handle
+
+  engine_eeprom = eeprom;
+
+  __HAL_RCC_TIM6_CLK_ENABLE();
+
+  // 1 MHz count, one update every WRITE_ENGINE_TICK
+  TIM6->CR1 = TIM_CR1_URS;
+  TIM6->PSC = (timer_clock() / 1000000U) - 1U;
+  TIM6->ARR = WRITE_ENGINE_TICK - 1U;
+  TIM6->EGR = TIM_EGR_UG;
+  TIM6->SR = 0U;
+  TIM6->DIER = TIM_DIER_UIE;
+
+  HAL_NVIC_SetPriority(TIM6_DAC1_IRQn, WRITE_ENGINE_IRQ_PRIORITY, 0U);
+  HAL_NVIC_EnableIRQ(TIM6_DAC1_IRQn);
+}
+
+write_engine_status_t write_engine_enqueue(uint16_t address, const uint8_t* data, uint16_t size) {
+  assert_param(data && (size <= DATA_PACKET_SIZE)); // Ensure packet
+
+  if ((jobs_head - jobs_tail) >= WRITE_ENGINE_QUEUE_SIZE) {
+    return WRITE_ENGINE_ERR_FULL;
+  }
+
+  write_job_t* job = &jobs[jobs_head % WRITE_ENGINE_QUEUE_SIZE];
+  job->address = address;
+  job->size = size;
+  memcpy(job->data, data, size);
+
+  // Publish the job only once it is complete
+  __DMB();
+  ++jobs_head;
+  timer_start();
+
+  return WRITE_ENGINE_OK;
+}
+
+void write_engine_flush(void) {
+  while (jobs_head != jobs_tail) {
+    __WFI();
+  }
+}
+
+eeprom_status_t write_engine_result(uint16_t* address) {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  const eeprom_status_t status = result;
+  if (address) {
+    *address = result_address;
+  }
+  result = EEPROM_OK;
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+uint8_t write_engine_late(uint16_t* address) {
+  const uint32_t primask = __get_PRIMASK();
+  __disable_irq();
+  const uint8_t was_late = late;
+  if (address) {
+    *address = late_address;
+  }
+  late = 0U;
+  __set_PRIMASK(primask);
+
+  return was_late;
+}
+
+void write_engine_irq_handler(void) {
+  TIM6->SR = 0U;
+
+  if (jobs_head == jobs_tail) {
+    timer_stop();
+    return;
+  }
+  write_job_t* job = &jobs[jobs_tail % WRITE_ENGINE_QUEUE_SIZE];
+  const device_profile_t* device = engine_eeprom->device;
+
+  switch (state) {
+    case ENGINE_LOAD: {
+      if (page_loaded == 0U) {
+        // Bytes up to the end of the page, or the end of the job
+        const uint16_t page_size = (device->page_size > 1U) ? device->page_size : 1U;
+        const uint16_t address = job->address + offset;
+        loaded = page_size - (address % page_size);
+        if (loaded > (job->size - offset)) {
+          loaded = job->size - offset;
+        }
+      }
+
+      // At most WRITE_ENGINE_LOAD_MAX bytes per tick
+      uint16_t count = loaded - page_loaded;
+      if (count > WRITE_ENGINE_LOAD_MAX) {
+        count = WRITE_ENGINE_LOAD_MAX;
+      }
+      // A page resumed from the previous tick must still be within tBLC
+      const bus_timing_t* timing = &engine_eeprom->timing;
+      uint8_t page_late = page_loaded && timing->t_blc && ((timing_now() - engine_eeprom->strobed_at) > timing->t_blc);
+      page_late |= eeprom_load_page(engine_eeprom, job->address + offset + page_loaded, &job->data[offset + page_loaded], count);
+      if (page_late && !late) {
+        late = 1U;
+        late_address = job->address + offset;
+      }
+      page_loaded += count;
+      if (page_loaded < loaded) {
+        break;
+      }
+
+      // The write cycle is timed from the end of the load, however long it took
+      page_loaded = 0U;
+      loaded_at = timing_now();
+      write_time = timing_cycles(device->t_wc * 1000U);
+      write_timeout = timing_cycles(((EEPROM_WRITE_TIMEOUT_FACTOR * device->t_wc) + 1000U) * 1000U);
+      state = ENGINE_POLL;
+      break;
+    }
+
+    case ENGINE_POLL: {
+      const uint32_t elapsed = timing_now() - loaded_at;
+      const uint8_t last = job->data[offset + loaded - 1U];
+      eeprom_status_t status = eeprom_poll_write(engine_eeprom, last);
+      if ((engine_eeprom->completion == WRITE_COMPLETION_DELAY) && (elapsed < write_time)) {
+        status = EEPROM_BUSY;
+      }
+
+      if (status == EEPROM_OK) {
+        offset += loaded;
+        state = ENGINE_LOAD;
+        if (offset >= job->size) {
+          job_done();
+        }
+      } else if (elapsed > write_timeout) {
+        if (result == EEPROM_OK) {
+          result = EEPROM_ERR_TIMEOUT;
+          result_address = job->address + offset + loaded - 1U;
+        }
+        // Drop everything queued, the host resends from the failed packet
+        while (jobs_head != jobs_tail) {
+          job_done();
+        }
+      }
+      break;
+    }
+  }
+}
+
+//* Private Helper Functions
+
+static void timer_start(void) {
+  TIM6->CR1 |= TIM_CR1_CEN;
+}
+
+static void timer_stop(void) {
+  TIM6->CR1 &= ~TIM_CR1_CEN;
+}
+
+static uint32_t timer_clock(void) {
+  // APB1 timers run at twice PCLK1 whenever APB1 is divided
+  const uint32_t pclk1 = HAL_RCC_GetPCLK1Freq();
+  return (RCC->CFGR & RCC_CFGR_PPRE1_2) ? (2U * pclk1) : pclk1;
+}
+
+static void job_done(void) {
+  offset = 0U;
+  page_loaded = 0U;
+  state = ENGINE_LOAD;
+  ++jobs_tail;
+}
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Decodes tokenized log records (see eeprom_programmer/Core/Inc/log.h).
+
+Reads the raw UART stream from a capture file, a serial port or stdin, passes
+regular ASCII output through unchanged, and replaces every log record with the
+text rebuilt from the format strings stored in the `.log_fmt` section of the
+firmware ELF.
+
+Record framing (little-endian):
+  0x1E       Sync byte (ASCII RS), starts every record
+  len        Number of record bytes that follow, before escaping
+  lvl|argc   Bits 7-4: log level, bits 3-0: argument count
+  id         Format-string ID, 2 bytes (offset in .log_fmt)
+  args       argc raw 32-bit arguments, 4 bytes each
+
+After the sync byte, CR, LF, 0x1E and 0x1F are sent as 0x1F (ASCII US)
+followed by the byte XOR 0x20. A record never holds a line break, so a host
+reading lines is not thrown off by it, and a sync byte always starts a record.
+A record whose length doesn't match its argument count is dropped.
+
+Usage:
+  log_decode.py <firmware.elf> [capture.bin | /dev/ttyACM0 [baud]]
+"""
+import re
+import struct
+import sys
+
+LOG_RECORD_SYNC = 0x1E
+LOG_RECORD_ESC = 0x1F
+LOG_RECORD_ESC_XOR = 0x20
+LOG_RECORD_HEADER_SIZE = 5
+LOG_LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+
+# C length modifiers have no meaning in Python %-formatting
+C_LENGTH_MODIFIERS = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXoc%])")
+
+
+def read_log_fmt(elf_path):
+    """Returns the raw contents of the .log_fmt section of a 32-bit ELF."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError(f"{elf_path}: not a 32-bit ELF")
+    endian = "<" if elf[5] == 1 else ">"
+    e_shoff, = struct.unpack_from(endian + "I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from(endian + "HHH", elf, 0x2E)
+
+    def section(index):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from(endian + "IIIIII", elf, e_shoff + index * e_shentsize)
+
+    strtab = section(e_shstrndx)
+    for i in range(e_shnum):
+        sh = section(i)
+        name_start = strtab[4] + sh[0]
+        name = elf[name_start:elf.index(b"\0", name_start)].decode()
+        if name == ".log_fmt":
+            return elf[sh[4]:sh[4] + sh[5]]
+    raise ValueError(f"{elf_path}: no .log_fmt section (is LOG_LEVEL > LOG_LEVEL_NONE?)")
+
+
+def format_record(log_fmt, level, fmt_id, args):
+    end = log_fmt.find(b"\0", fmt_id)
+    if fmt_id >= len(log_fmt) or end < 0:
+        return f"[?] <unknown log id 0x{fmt_id:04X} args={args}>\n"
+    fmt = C_LENGTH_MODIFIERS.sub(r"%\1\2", log_fmt[fmt_id:end].decode(errors="replace"))
+    # Arguments are sent as raw 32-bit words, sign-extend signed conversions
+    conversions = [c for c in re.findall(r"%[-+ #0]*\d*(?:\.\d+)?([diuxXoc%])", fmt) if c != "%"]
+    values = []
+    for conversion, arg in zip(conversions, args):
+        if conversion in "di" and arg & 0x80000000:
+            arg -= 1 << 32
+        values.append(arg)
+    try:
+        text = fmt % tuple(values)
+    except (TypeError, ValueError):
+        text = f"{fmt!r} % {args}"
+    return f"[{LOG_LEVELS.get(level, '?')}] {text}"
+
+
+def decode(stream, log_fmt, out):
+    record = None  # Unescaped bytes after the sync byte, None outside a record
+    escaped = False
+    while True:
+        chunk = stream.read(1)
+        if not chunk:
+            break
+        byte = chunk[0]
+        if byte == LOG_RECORD_SYNC:
+            # A sync byte inside a record means the record was cut short
+            record, escaped = bytearray(), False
+            continue
+        if record is None:
+            # Pass regular output through
+            out.write(chunk.decode(errors="replace"))
+            continue
+        if byte == LOG_RECORD_ESC:
+            escaped = True
+            continue
+        if escaped:
+            byte ^= LOG_RECORD_ESC_XOR
+            escaped = False
+        record.append(byte)
+        # Wait for a complete record
+        if len(record) < 2 or len(record) < 1 + record[0]:
+            continue
+        length, level, argc = record[0], record[1] >> 4, record[1] & 0x0F
+        if length == LOG_RECORD_HEADER_SIZE - 2 + 4 * argc:
+            fmt_id, = struct.unpack_from("<H", record, 2)
+            args = list(struct.unpack_from(f"<{argc}I", record, LOG_RECORD_HEADER_SIZE - 1))
+            out.write(format_record(log_fmt, level, fmt_id, args))
+            out.flush()
+        record = None
+
+
+def main(argv):
+    if len(argv) < 2:
+        sys.stderr.write(__doc__)
+        return 1
+    log_fmt = read_log_fmt(argv[1])
+    if len(argv) < 3:
+        stream = sys.stdin.buffer
+    elif argv[2].startswith("/dev/") or argv[2].upper().startswith("COM"):
+        import serial  # pyserial, only needed for live decoding
+        stream = serial.Serial(argv[2], int(argv[3]) if len(argv) > 3 else 9600)
+    else:
+        stream = open(argv[2], "rb")
+    try:
+        decode(stream, log_fmt, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))